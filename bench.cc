@@ -0,0 +1,833 @@
+#include "bench.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <x86intrin.h>
+#define BENCH_HAVE_TSC 1
+#else
+#define BENCH_HAVE_TSC 0
+#endif
+
+bool BenchClock::calibrated = false;
+bool BenchClock::useTsc = false;
+double BenchClock::ticksPerNs = 1.0;
+
+static uint64_t steadyNs(){
+  return chrono::duration_cast<chrono::nanoseconds>(
+      chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/* CPUID 0x80000007 EDX bit 8: the TSC runs at a constant rate in all
+ * P-, C- and T-states, so it can stand in for wall-clock time */
+static bool invariantTsc(){
+#if BENCH_HAVE_TSC
+  unsigned int eax, ebx, ecx, edx;
+  if (__get_cpuid_max(0x80000000, NULL) < 0x80000007){
+    return false;
+  }
+  __cpuid(0x80000007, eax, ebx, ecx, edx);
+  return (edx >> 8) & 1;
+#else
+  return false;
+#endif
+}
+
+/* Takes the median of a few 20 ms comparisons against steady_clock */
+void BenchClock::calibrate(){
+  if (calibrated){
+    return;
+  }
+  calibrated = true;
+  useTsc = invariantTsc();
+  if (!useTsc){
+    return;
+  }
+#if BENCH_HAVE_TSC
+  vector<double> rates;
+  for (int i = 0; i < 5; i++){
+    uint64_t ns0 = steadyNs();
+    uint64_t tsc0 = __rdtsc();
+    uint64_t ns1;
+    do {
+      ns1 = steadyNs();
+    } while (ns1 - ns0 < 20000000);
+    uint64_t tsc1 = __rdtsc();
+    rates.push_back((double) (tsc1 - tsc0) / (double) (ns1 - ns0));
+  }
+  sort(rates.begin(), rates.end());
+  ticksPerNs = rates[rates.size() / 2];
+#endif
+}
+
+uint64_t BenchClock::now(){
+#if BENCH_HAVE_TSC
+  if (useTsc){
+    _mm_lfence(); /* keep earlier work from drifting past the read */
+    return __rdtsc();
+  }
+#endif
+  return steadyNs();
+}
+
+double BenchClock::toNs(uint64_t ticks){
+  return (double) ticks / ticksPerNs;
+}
+
+/* Two-sided 95% Student t quantiles for 1..30 degrees of freedom */
+static double tQuantile95(unsigned int df){
+  static const double table[30] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306,
+                                   2.262, 2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120,
+                                   2.110, 2.101, 2.093, 2.086, 2.080, 2.074, 2.069, 2.064,
+                                   2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+  if (df == 0){
+    return 0;
+  }
+  return df <= 30 ? table[df - 1] : 1.96;
+}
+
+/* Nearest-rank percentile of sorted samples */
+static double percentile(const vector<double>& sorted, double p){
+  if (sorted.empty()){
+    return 0;
+  }
+  size_t rank = (size_t) ceil(p * sorted.size());
+  return sorted[rank == 0 ? 0 : min(rank, sorted.size()) - 1];
+}
+
+/* Items per second in run r: over the summed latencies on one thread, over
+ * the wall time of the run on several */
+static double runOpsPerSec(const BenchResult& result, unsigned int r){
+  double total = r < result.wallNs.size() ? result.wallNs[r]
+                 : accumulate(result.runs[r].begin(), result.runs[r].end(), 0.0);
+  return total > 0 ? result.itemsPerOp * result.runs[r].size() * 1e9 / total : 0;
+}
+
+void BenchResult::summarize(){
+  vector<double> all;
+  vector<double> rates;
+  for (unsigned int r = 0; r < runs.size(); r++){
+    all.insert(all.end(), runs[r].begin(), runs[r].end());
+    double rate = runOpsPerSec(*this, r);
+    if (rate > 0){
+      rates.push_back(rate);
+    }
+  }
+  sort(all.begin(), all.end());
+  min = all.empty() ? 0 : all.front();
+  max = all.empty() ? 0 : all.back();
+  mean = all.empty() ? 0 : accumulate(all.begin(), all.end(), 0.0) / all.size();
+  p50 = percentile(all, 0.50);
+  p90 = percentile(all, 0.90);
+  p99 = percentile(all, 0.99);
+  p999 = percentile(all, 0.999);
+
+  opsPerSec = rates.empty() ? 0 : accumulate(rates.begin(), rates.end(), 0.0) / rates.size();
+  opsPerSecCi95 = 0;
+  if (rates.size() > 1){
+    double var = 0;
+    for (unsigned int i = 0; i < rates.size(); i++){
+      var += (rates[i] - opsPerSec) * (rates[i] - opsPerSec);
+    }
+    var /= rates.size() - 1;
+    opsPerSecCi95 = tQuantile95(rates.size() - 1) * sqrt(var / rates.size());
+  }
+}
+
+BenchResult benchRun(const string& name, const BenchConfig& config,
+                     const function<bool(unsigned int)>& op, unsigned int itemsPerOp){
+  BenchClock::calibrate();
+  BenchResult result;
+  result.name = name;
+  result.itemsPerOp = itemsPerOp;
+  result.runs.resize(config.runs);
+  unique_ptr<BenchCounters> counters(config.counters ? new BenchCounters() : NULL);
+  double totals[BenchCounters::EVENTS];
+  fill(totals, totals + BenchCounters::EVENTS, -1.0);
+  bool alloc = config.alloc && benchAllocAvailable();
+  double allocs = 0, allocBytes = 0, allocPeak = 0;
+  for (unsigned int r = 0; r < config.runs; r++){
+    for (unsigned int i = 0; i < config.warmup; i++){
+      op(i % max(1u, config.iterations));
+    }
+    vector<double>& samples = result.runs[r];
+    samples.reserve(config.iterations);
+    if (counters){
+      counters->start();
+    }
+    for (unsigned int i = 0; i < config.iterations; i++){
+      if (alloc){
+        benchAllocStart();
+      }
+      uint64_t begin = BenchClock::now();
+      bool ok = op(i);
+      uint64_t end = BenchClock::now();
+      if (alloc){
+        BenchAllocStats stats = benchAllocStop();
+        allocs += stats.allocations;
+        allocBytes += stats.bytes;
+        allocPeak = std::max(allocPeak, (double) stats.peak);
+      }
+      samples.push_back(BenchClock::toNs(end - begin));
+      if (!ok){
+        result.failures++;
+      }
+    }
+    if (counters){
+      counters->stop(totals);
+    }
+  }
+  /* Counts cover the timing code too; a few cycles next to any real kernel */
+  for (int e = 0; e < BenchCounters::EVENTS; e++){
+    if (totals[e] >= 0){
+      result.counts[e] = totals[e] / ((double) config.runs * config.iterations);
+    }
+  }
+  if (alloc){
+    result.allocsPerOp = allocs / ((double) config.runs * config.iterations);
+    result.allocBytesPerOp = allocBytes / ((double) config.runs * config.iterations);
+    result.allocPeakBytes = allocPeak;
+  }
+  result.summarize();
+  return result;
+}
+
+bool benchPinThread(unsigned int index){
+#if defined(__linux__)
+  cpu_set_t allowed;
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0 || CPU_COUNT(&allowed) == 0){
+    return false;
+  }
+  unsigned int target = index % CPU_COUNT(&allowed);
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++){
+    if (CPU_ISSET(cpu, &allowed) && target-- == 0){
+      cpu_set_t one;
+      CPU_ZERO(&one);
+      CPU_SET(cpu, &one);
+      return pthread_setaffinity_np(pthread_self(), sizeof(one), &one) == 0;
+    }
+  }
+  return false;
+#else
+  (void) index;
+  return false;
+#endif
+}
+
+bool benchCanPin(){
+#if defined(__linux__)
+  cpu_set_t allowed;
+  return sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+#else
+  return false;
+#endif
+}
+
+BenchResult benchRunParallel(const string& name, const BenchConfig& config,
+                             unsigned int threads, bool pin,
+                             const function<bool(unsigned int, unsigned int)>& op){
+  BenchClock::calibrate();
+  BenchResult result;
+  result.name = name;
+  result.threads = threads;
+  result.runs.resize(config.runs);
+  result.wallNs.resize(config.runs);
+  vector<vector<double> > samples(threads);
+  vector<unsigned int> failures(threads, 0);
+  for (unsigned int r = 0; r < config.runs; r++){
+    atomic<unsigned int> ready(0);
+    atomic<bool> go(false);
+    auto worker = [&](unsigned int t){
+      if (pin){
+        benchPinThread(t);
+      }
+      for (unsigned int i = 0; i < config.warmup; i++){
+        op(t, i % max(1u, config.iterations));
+      }
+      samples[t].clear();
+      samples[t].reserve(config.iterations);
+      ready++;
+      while (!go.load()){
+        this_thread::yield();
+      }
+      for (unsigned int i = 0; i < config.iterations; i++){
+        uint64_t begin = BenchClock::now();
+        bool ok = op(t, i);
+        uint64_t end = BenchClock::now();
+        samples[t].push_back(BenchClock::toNs(end - begin));
+        if (!ok){
+          failures[t]++;
+        }
+      }
+    };
+    vector<thread> pool;
+    for (unsigned int t = 0; t < threads; t++){
+      pool.push_back(thread(worker, t));
+    }
+    while (ready.load() < threads){
+      this_thread::yield();
+    }
+    uint64_t begin = BenchClock::now();
+    go = true;
+    for (unsigned int t = 0; t < threads; t++){
+      pool[t].join();
+    }
+    uint64_t end = BenchClock::now();
+    result.wallNs[r] = BenchClock::toNs(end - begin);
+    for (unsigned int t = 0; t < threads; t++){
+      result.runs[r].insert(result.runs[r].end(), samples[t].begin(), samples[t].end());
+    }
+  }
+  result.failures = accumulate(failures.begin(), failures.end(), 0u);
+  result.summarize();
+  return result;
+}
+
+void BenchReport::setParameter(const string& key, const string& value){
+  parameters.push_back(make_pair(key, value));
+}
+
+void BenchReport::add(BenchResult& result){
+  entries.push_back(result);
+}
+
+void BenchReport::addScheme(const BenchScheme& scheme){
+  schemes.push_back(scheme);
+}
+
+const BenchResult* BenchReport::find(const string& name, unsigned int threads){
+  for (unsigned int i = 0; i < entries.size(); i++){
+    if (entries[i].name == name && entries[i].threads == threads){
+      return &entries[i];
+    }
+  }
+  return NULL;
+}
+
+/* Throughput per thread as a fraction of the single-threaded throughput of
+ * the same operation; 0 when that was not measured */
+double BenchReport::efficiency(const BenchResult& result){
+  const BenchResult* single = find(result.name);
+  if (!single || single->opsPerSec <= 0){
+    return 0;
+  }
+  return result.opsPerSec / (result.threads * single->opsPerSec);
+}
+
+bool BenchReport::scaling(){
+  for (unsigned int i = 0; i < entries.size(); i++){
+    if (entries[i].threads > 1){
+      return true;
+    }
+  }
+  return false;
+}
+
+void BenchReport::write(ostream& out, BenchFormat format){
+  if (format == BENCH_JSON){
+    writeJson(out);
+  } else if (format == BENCH_CSV){
+    if (schemes.empty()){
+      writeCsv(out);
+    } else {
+      writeComparisonCsv(out);
+    }
+  } else {
+    if (scaling()){
+      writeScalingText(out);
+    } else if (schemes.empty()){
+      writeText(out);
+      writeCountersText(out);
+      writeAllocText(out);
+    } else {
+      writeComparisonText(out);
+    }
+  }
+}
+
+/* Reference cycles per call and per unit at the median, when ticks are TSC
+ * cycles; 0 otherwise */
+static double cyclesPerOp(const BenchResult& r){
+  return BenchClock::usesTsc() ? r.p50 * BenchClock::tscGhz() : 0;
+}
+
+static double cyclesPerUnit(const BenchResult& r){
+  return r.unitsPerOp > 0 ? cyclesPerOp(r) / r.unitsPerOp : 0;
+}
+
+void BenchReport::writeHeader(ostream& out){
+  out << "clock: " << BenchClock::source();
+  if (BenchClock::usesTsc()){
+    out << " (" << fixed << setprecision(3) << BenchClock::tscGhz() << " GHz)";
+  }
+  out << ", runs: " << config.runs << ", iterations: " << config.iterations
+      << ", warmup: " << config.warmup
+      << ", counters: " << (config.counters ? BenchCounters::status() : "off");
+  if (config.alloc){
+    out << ", alloc: " << (benchAllocAvailable() ? "on" : "unavailable (needs glibc)");
+  }
+  for (unsigned int i = 0; i < parameters.size(); i++){
+    out << ", " << parameters[i].first << ": " << parameters[i].second;
+  }
+  out << endl;
+}
+
+void BenchReport::writeText(ostream& out){
+  writeHeader(out);
+  size_t width = 9;
+  for (unsigned int i = 0; i < entries.size(); i++){
+    width = std::max(width, entries[i].name.size());
+  }
+  out << left << setw(width + 2) << "operation" << right
+      << setw(12) << "min us" << setw(12) << "p50 us" << setw(12) << "p90 us"
+      << setw(12) << "p99 us" << setw(12) << "p99.9 us" << setw(12) << "max us"
+      << setw(14) << "ops/s" << setw(12) << "+-95%" << setw(12) << "cyc/op"
+      << setw(16) << "cyc/unit" << setw(7) << "fail" << endl;
+  out << string(width + 2 + 12 * 6 + 14 + 12 + 12 + 16 + 7, '-') << endl;
+  for (unsigned int i = 0; i < entries.size(); i++){
+    BenchResult& r = entries[i];
+    out << left << setw(width + 2) << r.name << right << fixed << setprecision(3)
+        << setw(12) << r.min / 1e3 << setw(12) << r.p50 / 1e3 << setw(12) << r.p90 / 1e3
+        << setw(12) << r.p99 / 1e3 << setw(12) << r.p999 / 1e3 << setw(12) << r.max / 1e3
+        << setprecision(1) << setw(14) << r.opsPerSec << setw(12) << r.opsPerSecCi95;
+    if (cyclesPerOp(r) > 0){
+      out << setprecision(0) << setw(12) << cyclesPerOp(r);
+    } else {
+      out << setw(12) << "-";
+    }
+    if (cyclesPerUnit(r) > 0){
+      ostringstream perUnit;
+      perUnit << fixed << setprecision(2) << cyclesPerUnit(r) << "/" << r.unit;
+      out << setw(16) << perUnit.str();
+    } else {
+      out << setw(16) << "-";
+    }
+    out << setw(7) << r.failures << endl;
+  }
+}
+
+/* Hardware events per call next to the median latency, for the results
+ * that have them */
+void BenchReport::writeCountersText(ostream& out){
+  size_t width = 9;
+  bool any = false;
+  for (unsigned int i = 0; i < entries.size(); i++){
+    width = std::max(width, entries[i].name.size());
+    any = any || entries[i].hasCounts();
+  }
+  if (!any){
+    return;
+  }
+  out << endl << left << setw(width + 2) << "per call" << right << setw(12) << "p50 us"
+      << setw(14) << "cycles" << setw(14) << "instructions" << setw(7) << "IPC"
+      << setw(12) << "L1d miss" << setw(12) << "LLC miss" << setw(12) << "br miss" << endl;
+  out << string(width + 2 + 12 + 14 * 2 + 7 + 12 * 3, '-') << endl;
+  for (unsigned int i = 0; i < entries.size(); i++){
+    BenchResult& r = entries[i];
+    if (!r.hasCounts()){
+      continue;
+    }
+    double cycles = r.counts[BenchCounters::CYCLES];
+    double instructions = r.counts[BenchCounters::INSTRUCTIONS];
+    out << left << setw(width + 2) << r.name << right << fixed << setprecision(3)
+        << setw(12) << r.p50 / 1e3 << setprecision(0);
+    for (int e = 0; e < BenchCounters::EVENTS; e++){
+      if (e == BenchCounters::L1D_MISSES){
+        if (cycles > 0 && instructions >= 0){
+          out << setprecision(2) << setw(7) << instructions / cycles << setprecision(0);
+        } else {
+          out << setw(7) << "-";
+        }
+      }
+      int w = e <= BenchCounters::INSTRUCTIONS ? 14 : 12;
+      if (r.counts[e] >= 0){
+        out << setw(w) << r.counts[e];
+      } else {
+        out << setw(w) << "-";
+      }
+    }
+    out << endl;
+  }
+}
+
+/* Heap use per call, and per rejection-sampling attempt where the driver
+ * knows the attempt count */
+void BenchReport::writeAllocText(ostream& out){
+  size_t width = 9;
+  bool any = false;
+  for (unsigned int i = 0; i < entries.size(); i++){
+    width = std::max(width, entries[i].name.size());
+    any = any || entries[i].hasAllocs();
+  }
+  if (!any){
+    return;
+  }
+  out << endl << left << setw(width + 2) << "heap" << right << setw(12) << "allocs/op"
+      << setw(12) << "bytes/op" << setw(12) << "peak B" << setw(12) << "attempts/op"
+      << setw(16) << "allocs/attempt" << setw(16) << "bytes/attempt" << endl;
+  out << string(width + 2 + 12 * 4 + 16 * 2, '-') << endl;
+  for (unsigned int i = 0; i < entries.size(); i++){
+    BenchResult& r = entries[i];
+    if (!r.hasAllocs()){
+      continue;
+    }
+    out << left << setw(width + 2) << r.name << right << fixed << setprecision(1)
+        << setw(12) << r.allocsPerOp << setw(12) << r.allocBytesPerOp
+        << setprecision(0) << setw(12) << r.allocPeakBytes;
+    if (r.attemptsPerOp > 0){
+      out << setprecision(2) << setw(12) << r.attemptsPerOp << setprecision(1)
+          << setw(16) << r.allocsPerOp / r.attemptsPerOp
+          << setw(16) << r.allocBytesPerOp / r.attemptsPerOp;
+    } else {
+      out << setw(12) << "-" << setw(16) << "-" << setw(16) << "-";
+    }
+    out << endl;
+  }
+}
+
+void BenchReport::writeComparisonText(ostream& out){
+  writeHeader(out);
+  size_t width = 6;
+  for (unsigned int i = 0; i < schemes.size(); i++){
+    width = std::max(width, schemes[i].name.size());
+  }
+  out << left << setw(width + 2) << "scheme" << right
+      << setw(12) << "keygen us" << setw(12) << "sign us" << setw(12) << "sign p99"
+      << setw(12) << "verify us" << setw(12) << "verify p99" << setw(11) << "sign/s"
+      << setw(11) << "verify/s" << setw(8) << "pk B" << setw(8) << "sk B" << setw(8) << "sig B"
+      << setw(7) << "fail" << endl;
+  out << string(width + 2 + 12 * 5 + 11 * 2 + 8 * 3 + 7, '-') << endl;
+  for (unsigned int i = 0; i < schemes.size(); i++){
+    const BenchScheme& s = schemes[i];
+    const BenchResult* keygen = find(s.name + " keygen");
+    const BenchResult* sign = find(s.name + " sign");
+    const BenchResult* verify = find(s.name + " verify");
+    if (!keygen || !sign || !verify){
+      continue;
+    }
+    out << left << setw(width + 2) << s.name << right << fixed << setprecision(1)
+        << setw(12) << keygen->p50 / 1e3 << setw(12) << sign->p50 / 1e3
+        << setw(12) << sign->p99 / 1e3 << setw(12) << verify->p50 / 1e3
+        << setw(12) << verify->p99 / 1e3 << setw(11) << sign->opsPerSec
+        << setw(11) << verify->opsPerSec << setw(8) << s.publicKeyBytes
+        << setw(8) << s.secretKeyBytes << setw(8) << s.signatureBytes
+        << setw(7) << keygen->failures + sign->failures + verify->failures << endl;
+  }
+  out << "latencies are medians unless marked p99; sizes in bytes" << endl;
+}
+
+void BenchReport::writeComparisonCsv(ostream& out){
+  out << setprecision(10)
+      << "scheme,keygen_p50_ns,sign_p50_ns,sign_p99_ns,verify_p50_ns,verify_p99_ns,"
+      << "sign_ops_per_sec,sign_ops_per_sec_ci95,verify_ops_per_sec,verify_ops_per_sec_ci95,"
+      << "public_key_bytes,secret_key_bytes,signature_bytes,failures" << endl;
+  for (unsigned int i = 0; i < schemes.size(); i++){
+    const BenchScheme& s = schemes[i];
+    const BenchResult* keygen = find(s.name + " keygen");
+    const BenchResult* sign = find(s.name + " sign");
+    const BenchResult* verify = find(s.name + " verify");
+    if (!keygen || !sign || !verify){
+      continue;
+    }
+    out << s.name << "," << keygen->p50 << "," << sign->p50 << "," << sign->p99 << ","
+        << verify->p50 << "," << verify->p99 << "," << sign->opsPerSec << ","
+        << sign->opsPerSecCi95 << "," << verify->opsPerSec << "," << verify->opsPerSecCi95
+        << "," << s.publicKeyBytes << "," << s.secretKeyBytes << "," << s.signatureBytes
+        << "," << keygen->failures + sign->failures + verify->failures << endl;
+  }
+}
+
+void BenchReport::writeScalingText(ostream& out){
+  writeHeader(out);
+  size_t width = 9;
+  for (unsigned int i = 0; i < entries.size(); i++){
+    width = std::max(width, entries[i].name.size());
+  }
+  out << left << setw(width + 2) << "operation" << right << setw(8) << "threads"
+      << setw(14) << "ops/s" << setw(12) << "+-95%" << setw(14) << "ops/s/thread"
+      << setw(12) << "efficiency" << setw(12) << "p50 us" << setw(12) << "p99 us"
+      << setw(7) << "fail" << endl;
+  out << string(width + 2 + 8 + 14 + 12 + 14 + 12 + 12 + 12 + 7, '-') << endl;
+  for (unsigned int i = 0; i < entries.size(); i++){
+    BenchResult& r = entries[i];
+    out << left << setw(width + 2) << r.name << right << setw(8) << r.threads << fixed
+        << setprecision(1) << setw(14) << r.opsPerSec << setw(12) << r.opsPerSecCi95
+        << setw(14) << r.opsPerSec / r.threads;
+    if (efficiency(r) > 0){
+      ostringstream percent;
+      percent << fixed << setprecision(1) << 100 * efficiency(r) << "%";
+      out << setw(12) << percent.str();
+    } else {
+      out << setw(12) << "-";
+    }
+    out << setprecision(3) << setw(12) << r.p50 / 1e3 << setw(12) << r.p99 / 1e3
+        << setw(7) << r.failures << endl;
+  }
+  out << "efficiency is ops/s per thread over ops/s on one thread" << endl;
+}
+
+static string jsonString(const string& s){
+  string out = "\"";
+  for (unsigned int i = 0; i < s.size(); i++){
+    if (s[i] == '"' || s[i] == '\\'){
+      out += '\\';
+    }
+    out += s[i];
+  }
+  return out + "\"";
+}
+
+void BenchReport::writeJson(ostream& out){
+  out << setprecision(10) << "{" << endl;
+  out << "  \"clock\": {\"source\": " << jsonString(BenchClock::source())
+      << ", \"tsc_ghz\": " << (BenchClock::usesTsc() ? BenchClock::tscGhz() : 0) << "}," << endl;
+  out << "  \"config\": {\"runs\": " << config.runs << ", \"iterations\": " << config.iterations
+      << ", \"warmup\": " << config.warmup << ", \"counters\": "
+      << jsonString(config.counters ? BenchCounters::status() : "off");
+  for (unsigned int i = 0; i < parameters.size(); i++){
+    out << ", " << jsonString(parameters[i].first) << ": " << jsonString(parameters[i].second);
+  }
+  out << "}," << endl;
+  out << "  \"results\": [" << endl;
+  for (unsigned int i = 0; i < entries.size(); i++){
+    BenchResult& r = entries[i];
+    out << "    {\"name\": " << jsonString(r.name) << ", \"threads\": " << r.threads
+        << ", \"efficiency\": " << efficiency(r) << ", \"items_per_op\": " << r.itemsPerOp
+        << ", \"units_per_op\": " << r.unitsPerOp << ", \"unit\": " << jsonString(r.unit)
+        << ", \"failures\": " << r.failures
+        << ", \"min_ns\": " << r.min << ", \"p50_ns\": " << r.p50 << ", \"p90_ns\": " << r.p90
+        << ", \"p99_ns\": " << r.p99 << ", \"p999_ns\": " << r.p999 << ", \"max_ns\": " << r.max
+        << ", \"mean_ns\": " << r.mean << ", \"ops_per_sec\": " << r.opsPerSec
+        << ", \"ops_per_sec_ci95\": " << r.opsPerSecCi95
+        << ", \"cycles_per_op\": " << cyclesPerOp(r)
+        << ", \"cycles_per_unit\": " << cyclesPerUnit(r) << ", \"counters\": ";
+    if (r.hasCounts()){
+      out << "{";
+      for (int e = 0; e < BenchCounters::EVENTS; e++){
+        out << (e ? ", " : "") << jsonString(BenchCounters::name((BenchCounters::Event) e))
+            << ": ";
+        if (r.counts[e] >= 0){
+          out << r.counts[e];
+        } else {
+          out << "null";
+        }
+      }
+      out << "}";
+    } else {
+      out << "null";
+    }
+    if (r.hasAllocs()){
+      out << ", \"allocs_per_op\": " << r.allocsPerOp
+          << ", \"alloc_bytes_per_op\": " << r.allocBytesPerOp
+          << ", \"alloc_peak_bytes\": " << r.allocPeakBytes;
+    }
+    if (r.attemptsPerOp > 0){
+      out << ", \"attempts_per_op\": " << r.attemptsPerOp;
+    }
+    out << ", \"run_ops_per_sec\": [";
+    for (unsigned int k = 0; k < r.runs.size(); k++){
+      out << (k ? ", " : "") << runOpsPerSec(r, k);
+    }
+    out << "]}" << (i + 1 < entries.size() ? "," : "") << endl;
+  }
+  out << "  ]";
+  if (!schemes.empty()){
+    out << "," << endl << "  \"comparison\": [" << endl;
+    for (unsigned int i = 0; i < schemes.size(); i++){
+      const BenchScheme& s = schemes[i];
+      out << "    {\"scheme\": " << jsonString(s.name)
+          << ", \"public_key_bytes\": " << s.publicKeyBytes
+          << ", \"secret_key_bytes\": " << s.secretKeyBytes
+          << ", \"signature_bytes\": " << s.signatureBytes << "}"
+          << (i + 1 < schemes.size() ? "," : "") << endl;
+    }
+    out << "  ]";
+  }
+  out << endl << "}" << endl;
+}
+
+void BenchReport::writeCsv(ostream& out){
+  out << setprecision(10)
+      << "name,threads,efficiency,items_per_op,units_per_op,unit,failures,min_ns,p50_ns,"
+      << "p90_ns,p99_ns,p999_ns,max_ns,mean_ns,ops_per_sec,ops_per_sec_ci95,cycles_per_op,"
+      << "cycles_per_unit";
+  for (int e = 0; e < BenchCounters::EVENTS; e++){
+    out << "," << BenchCounters::name((BenchCounters::Event) e);
+  }
+  out << ",allocs_per_op,alloc_bytes_per_op,alloc_peak_bytes,attempts_per_op" << endl;
+  for (unsigned int i = 0; i < entries.size(); i++){
+    BenchResult& r = entries[i];
+    out << r.name << "," << r.threads << "," << efficiency(r) << "," << r.itemsPerOp
+        << "," << r.unitsPerOp << "," << r.unit << "," << r.failures << ","
+        << r.min << "," << r.p50 << "," << r.p90 << "," << r.p99 << "," << r.p999 << ","
+        << r.max << "," << r.mean << "," << r.opsPerSec << "," << r.opsPerSecCi95 << ","
+        << cyclesPerOp(r) << "," << cyclesPerUnit(r);
+    for (int e = 0; e < BenchCounters::EVENTS; e++){
+      out << ",";
+      if (r.counts[e] >= 0){
+        out << r.counts[e];
+      }
+    }
+    if (r.hasAllocs()){
+      out << "," << r.allocsPerOp << "," << r.allocBytesPerOp << "," << r.allocPeakBytes;
+    } else {
+      out << ",,,";
+    }
+    out << ",";
+    if (r.attemptsPerOp > 0){
+      out << r.attemptsPerOp;
+    }
+    out << endl;
+  }
+}
+
+bool benchSplitArgs(int argc, char* argv[], vector<pair<string, string> >& args){
+  for (int i = 1; i < argc; i++){
+    string arg = argv[i];
+    if (arg == "--help" || arg == "-h"){
+      return false;
+    }
+    if (arg.compare(0, 2, "--") != 0){
+      cerr << "unexpected argument: " << arg << endl;
+      return false;
+    }
+    string name = arg.substr(2);
+    string value;
+    size_t eq = name.find('=');
+    if (eq != string::npos){
+      value = name.substr(eq + 1);
+      name = name.substr(0, eq);
+    } else if (i + 1 < argc){
+      value = argv[++i];
+    } else {
+      cerr << "missing value for --" << name << endl;
+      return false;
+    }
+    args.push_back(make_pair(name, value));
+  }
+  return true;
+}
+
+bool benchParseUnsigned(const string& value, unsigned int& out){
+  char* end = NULL;
+  unsigned long number = strtoul(value.c_str(), &end, 10);
+  if (value.empty() || *end != '\0' || value[0] == '-'){
+    return false;
+  }
+  out = number;
+  return true;
+}
+
+static bool parseDouble(const string& value, double& out){
+  char* end = NULL;
+  double number = strtod(value.c_str(), &end);
+  if (value.empty() || *end != '\0' || !(number >= 0)){
+    return false;
+  }
+  out = number;
+  return true;
+}
+
+bool benchCommonOption(const string& name, const string& value, BenchConfig& config,
+                       BenchOutput& output){
+  unsigned int number = 0;
+  bool isNumber = benchParseUnsigned(value, number);
+  double real = 0;
+  bool isReal = parseDouble(value, real);
+  if (name == "iterations" && isNumber && number > 0){
+    config.iterations = number;
+  } else if (name == "warmup" && isNumber){
+    config.warmup = number;
+  } else if (name == "runs" && isNumber && number > 0){
+    config.runs = number;
+  } else if (name == "counters" && (value == "on" || value == "off")){
+    config.counters = value == "on";
+  } else if (name == "alloc" && (value == "on" || value == "off")){
+    config.alloc = value == "on";
+  } else if (name == "format" && (value == "text" || value == "json" || value == "csv")){
+    output.format = value == "json" ? BENCH_JSON : value == "csv" ? BENCH_CSV : BENCH_TEXT;
+  } else if (name == "output"){
+    output.path = value;
+  } else if (name == "save-baseline"){
+    output.saveBaseline = value;
+  } else if (name == "baseline-name"){
+    output.baselineName = value;
+  } else if (name == "baseline"){
+    output.baseline = value;
+  } else if (name == "threshold" && isReal){
+    output.threshold = real;
+  } else if (name == "alpha" && isReal && real > 0 && real < 1){
+    output.alpha = real;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void benchCommonUsage(ostream& out){
+  out << "  --iterations=N                timed operations per run (default 1000)" << endl
+      << "  --warmup=N                    untimed operations before each run (default 20)" << endl
+      << "  --runs=N                      repetitions, for confidence intervals (default 3)" << endl
+      << "  --counters=on|off             hardware counters per call where perf_event_open" << endl
+      << "                                works (default on)" << endl
+      << "  --alloc=on|off                count heap allocations, bytes and peak per call" << endl
+      << "                                (default off; the counting malloc and free are linked" << endl
+      << "                                in and run either way, off just skips the counts)" << endl
+      << "  --format=text|json|csv        report format (default text)" << endl
+      << "  --output=FILE                 write the report to FILE instead of stdout" << endl
+      << "  --save-baseline=FILE          store this run's samples, machine and build in FILE" << endl
+      << "  --baseline-name=NAME          label stored in the baseline (default FILE)" << endl
+      << "  --baseline=FILE               compare against a stored run; exit status 3 if" << endl
+      << "                                any operation regressed" << endl
+      << "  --threshold=PCT               median slowdown that counts as a regression (default 5)" << endl
+      << "  --alpha=P                     significance level of the rank-sum test (default 0.01)" << endl;
+}
+
+bool benchWriteReport(BenchReport& report, BenchFormat format, const string& path){
+  if (path.empty()){
+    report.write(cout, format);
+    return true;
+  }
+  ofstream out(path.c_str());
+  report.write(out, format);
+  if (!out){
+    cerr << "could not write " << path << endl;
+    return false;
+  }
+  return true;
+}
+
+int benchFinish(BenchReport& report, const BenchOutput& output){
+  if (!benchWriteReport(report, output.format, output.path)){
+    return 1;
+  }
+  if (!output.saveBaseline.empty()){
+    string name = output.baselineName.empty() ? output.saveBaseline : output.baselineName;
+    if (!benchSaveBaseline(report, output.saveBaseline, name)){
+      return 1;
+    }
+  }
+  if (output.baseline.empty()){
+    return 0;
+  }
+  BenchBaseline baseline;
+  if (!benchLoadBaseline(output.baseline, baseline)){
+    return 1;
+  }
+  /* Keep machine-readable reports on stdout parseable */
+  ostream& out = output.path.empty() && output.format != BENCH_TEXT ? cerr : cout;
+  return benchCompare(report, baseline, output.threshold, output.alpha, out) ? 3 : 0;
+}
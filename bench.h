@@ -0,0 +1,237 @@
+#ifndef BENCH_H_
+#define BENCH_H_
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* Monotonic tick source for per-operation timing. On x86 with an invariant
+ * TSC this is rdtsc, calibrated once against steady_clock; otherwise ticks
+ * are steady_clock nanoseconds. */
+class BenchClock {
+public:
+  static void calibrate();
+  static uint64_t now();
+  static double toNs(uint64_t ticks);
+  static bool usesTsc(){return useTsc;}
+  static double tscGhz(){return ticksPerNs;} /* 1.0 when ticks are ns */
+  static const char* source(){return useTsc ? "tsc" : "steady_clock";}
+
+private:
+  static bool calibrated;
+  static bool useTsc;
+  static double ticksPerNs;
+};
+
+/* Hardware event counts of the calling thread through Linux perf_event_open,
+ * user space only. Where the counters cannot be opened (a VM or container
+ * without a PMU, perf_event_paranoid, another OS) available() is false and
+ * status() says why; benchmarks then simply run without them. */
+class BenchCounters {
+public:
+  enum Event { CYCLES, INSTRUCTIONS, L1D_MISSES, LLC_MISSES, BRANCH_MISSES, EVENTS };
+  BenchCounters();
+  ~BenchCounters();
+  bool available() const {return leader >= 0;}
+  void start();
+  /* Adds the counts since start() to totals, scaled up if the kernel had
+   * to multiplex them; events that could not be opened are left alone */
+  void stop(double totals[EVENTS]);
+  bool has(Event event) const {return slot[event] >= 0;}
+  /* "on", or why the counters are unavailable, as of the last attempt */
+  static const string& status(){return lastStatus;}
+  static const char* name(Event event);
+
+private:
+  int fds[EVENTS];
+  int slot[EVENTS];  /* position in the group read, -1 if not opened */
+  int leader;
+  static string lastStatus;
+};
+
+/* Heap accounting: while on, every malloc, calloc, realloc, aligned
+ * allocation and free (and so every operator new and delete) is counted.
+ * Needs glibc, whose allocator bench_alloc.cc wraps; elsewhere
+ * benchAllocAvailable() is false. The wrappers replace the allocator in
+ * every program linking bench_alloc.o, with accounting off too, where they
+ * only add a flag test to each call. */
+struct BenchAllocStats {
+  uint64_t allocations;
+  uint64_t bytes;       /* requested */
+  uint64_t peak;        /* most live bytes above the level at benchAllocStart() */
+};
+bool benchAllocAvailable();
+void benchAllocStart();
+BenchAllocStats benchAllocStop();
+
+enum BenchFormat { BENCH_TEXT, BENCH_JSON, BENCH_CSV };
+
+struct BenchConfig {
+  unsigned int iterations; /* timed operations per run */
+  unsigned int warmup;     /* untimed operations before each run */
+  unsigned int runs;       /* independent repetitions */
+  bool counters;           /* collect hardware counters when available */
+  bool alloc;              /* count heap allocations per call */
+  BenchConfig() : iterations(1000), warmup(20), runs(3), counters(true), alloc(false) {}
+};
+
+/* Latency samples (ns) of one operation, kept per run */
+struct BenchResult {
+  string name;
+  unsigned int itemsPerOp; /* e.g. messages per signBatch() call */
+  unsigned int threads;    /* workers running the operation concurrently */
+  double unitsPerOp;       /* bytes or coefficients processed per call, 0 if n/a */
+  string unit;             /* what unitsPerOp counts, e.g. "B" or "coeff" */
+  unsigned int failures;   /* operations that reported an error */
+  vector<vector<double> > runs;
+  vector<double> wallNs;   /* per run, when threads > 1: elapsed time of the whole run */
+
+  /* Filled in by summarize() */
+  double min, p50, p90, p99, p999, max, mean;
+  double opsPerSec;       /* items per second, mean over runs, summed over threads */
+  double opsPerSecCi95;   /* half-width of the 95% confidence interval */
+
+  /* Mean hardware events per call, -1 where not counted */
+  double counts[BenchCounters::EVENTS];
+
+  /* With BenchConfig::alloc: mean allocations and requested bytes per
+   * call, and the most live heap any one call added; -1 otherwise */
+  double allocsPerOp;
+  double allocBytesPerOp;
+  double allocPeakBytes;
+  double attemptsPerOp;   /* rejection-sampling attempts per call, 0 if n/a */
+
+  BenchResult() : itemsPerOp(1), threads(1), unitsPerOp(0), failures(0), min(0), p50(0), p90(0),
+                  p99(0), p999(0), max(0), mean(0), opsPerSec(0), opsPerSecCi95(0),
+                  allocsPerOp(-1), allocBytesPerOp(-1), allocPeakBytes(-1), attemptsPerOp(0) {
+    fill(counts, counts + BenchCounters::EVENTS, -1.0);
+  }
+  bool hasCounts() const {return counts[BenchCounters::CYCLES] >= 0;}
+  bool hasAllocs() const {return allocsPerOp >= 0;}
+  void summarize();
+};
+
+/* Times op(i) for i = 0 .. iterations - 1 in each run, one sample per call,
+ * after config.warmup untimed calls. op returns false to count a failure. */
+BenchResult benchRun(const string& name, const BenchConfig& config,
+                     const function<bool(unsigned int)>& op, unsigned int itemsPerOp = 1);
+
+/* Runs op(thread, i) on threads workers at once, each pinned to its own
+ * CPU when pin is set and the platform allows it. Every worker does the
+ * warmup, waits for the others, then makes config.iterations timed calls;
+ * throughput is all calls over the wall time of the run. */
+BenchResult benchRunParallel(const string& name, const BenchConfig& config,
+                             unsigned int threads, bool pin,
+                             const function<bool(unsigned int, unsigned int)>& op);
+
+/* Pins the calling thread to the index-th CPU it may run on (wrapping
+ * around); returns false where affinity is not supported */
+bool benchPinThread(unsigned int index);
+bool benchCanPin();
+
+/* One row of the comparison table. Its latencies come from the results
+ * named "<name> keygen", "<name> sign" and "<name> verify". */
+struct BenchScheme {
+  string name;
+  unsigned int publicKeyBytes;
+  unsigned int secretKeyBytes;
+  unsigned int signatureBytes;
+};
+
+/* Collects results and writes them as an aligned table, JSON or CSV. Once
+ * schemes are added, the text and CSV forms become one comparison table
+ * and JSON gains a "comparison" array. Results run on several threads are
+ * shown as a scaling table, with efficiency relative to the same
+ * operation on one thread. */
+class BenchReport {
+public:
+  explicit BenchReport(const BenchConfig& config) : config(config) {}
+  void setParameter(const string& key, const string& value);
+  void add(BenchResult& result);
+  void addScheme(const BenchScheme& scheme);
+  void write(ostream& out, BenchFormat format);
+  vector<BenchResult>& results(){return entries;}
+  const vector<pair<string, string> >& parameterList(){return parameters;}
+  const BenchConfig& benchConfig(){return config;}
+
+private:
+  BenchConfig config;
+  vector<pair<string, string> > parameters;
+  vector<BenchResult> entries;
+  vector<BenchScheme> schemes;
+  const BenchResult* find(const string& name, unsigned int threads = 1);
+  double efficiency(const BenchResult& result);
+  bool scaling();
+  void writeHeader(ostream& out);
+  void writeText(ostream& out);
+  void writeComparisonText(ostream& out);
+  void writeComparisonCsv(ostream& out);
+  void writeScalingText(ostream& out);
+  void writeCountersText(ostream& out);
+  void writeAllocText(ostream& out);
+  void writeJson(ostream& out);
+  void writeCsv(ostream& out);
+};
+
+/* Where the report goes, and the stored baseline to save this run as or to
+ * compare it with */
+struct BenchOutput {
+  BenchFormat format;
+  string path;           /* report file, stdout when empty */
+  string saveBaseline;   /* file to store this run in */
+  string baselineName;   /* label stored with it, the file name by default */
+  string baseline;       /* file of an earlier run to compare against */
+  double threshold;      /* percent slowdown of the median that counts as a regression */
+  double alpha;          /* significance level of the one-sided rank-sum test */
+  BenchOutput() : format(BENCH_TEXT), threshold(5.0), alpha(0.01) {}
+};
+
+/* A saved run: every result with its raw per-run samples, plus what it ran
+ * on, so results taken on another machine or build can be told apart */
+struct BenchBaseline {
+  string name;
+  string machine;
+  string build;
+  vector<pair<string, string> > parameters;
+  vector<BenchResult> results;
+};
+
+string benchMachine();
+string benchBuild();
+bool benchSaveBaseline(BenchReport& report, const string& path, const string& name);
+bool benchLoadBaseline(const string& path, BenchBaseline& baseline);
+
+/* Prints each result of the report against the same operation in baseline.
+ * An operation regresses when its median latency grew by more than the
+ * threshold and a Mann-Whitney U test on the latencies says the new run is
+ * slower at the alpha level, or, when both runs counted allocations, when
+ * its allocations, bytes or peak heap per call grew by more than the
+ * threshold. Returns true if any operation regressed. */
+bool benchCompare(BenchReport& report, const BenchBaseline& baseline, double threshold,
+                  double alpha, ostream& out);
+
+/* Command line helpers shared by the benchmark drivers. Options are written
+ * --name=value or --name value; benchSplitArgs() returns false on --help or
+ * a malformed argument. benchCommonOption() applies --iterations, --warmup,
+ * --runs, --format, --output and the baseline options, returning false for
+ * any other name or an invalid value. */
+bool benchSplitArgs(int argc, char* argv[], vector<pair<string, string> >& args);
+bool benchParseUnsigned(const string& value, unsigned int& out);
+bool benchCommonOption(const string& name, const string& value, BenchConfig& config,
+                       BenchOutput& output);
+void benchCommonUsage(ostream& out);
+
+/* Writes the report to path, or stdout when path is empty */
+bool benchWriteReport(BenchReport& report, BenchFormat format, const string& path);
+
+/* Writes the report, then saves and compares baselines as requested.
+ * Returns the exit status: 0, 1 if a file could not be read or written, or
+ * 3 if an operation regressed against the baseline. */
+int benchFinish(BenchReport& report, const BenchOutput& output);
+
+#endif
@@ -0,0 +1,136 @@
+#include "bench.h"
+#include <atomic>
+#include <errno.h>
+#include <stdlib.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#define BENCH_HAVE_ALLOC 1
+#else
+#define BENCH_HAVE_ALLOC 0
+#endif
+
+/* Counted with relaxed atomics; accounting is meant for one benchmarked
+ * thread, though other threads' calls are not lost */
+static atomic<bool> accounting(false);
+static atomic<uint64_t> allocations(0);
+static atomic<uint64_t> bytes(0);
+static atomic<int64_t> live(0);
+static atomic<int64_t> peak(0);
+
+bool benchAllocAvailable(){
+  return BENCH_HAVE_ALLOC;
+}
+
+void benchAllocStart(){
+  allocations = 0;
+  bytes = 0;
+  live = 0;
+  peak = 0;
+  accounting = true;
+}
+
+BenchAllocStats benchAllocStop(){
+  accounting = false;
+  BenchAllocStats stats = {allocations.load(), bytes.load(),
+                           (uint64_t) max<int64_t>(0, peak.load())};
+  return stats;
+}
+
+#if BENCH_HAVE_ALLOC
+/* Live bytes are tracked by usable size, which free() can see too */
+static void noteAlloc(void* ptr, size_t size){
+  if (!ptr || !accounting.load(memory_order_relaxed)){
+    return;
+  }
+  allocations.fetch_add(1, memory_order_relaxed);
+  bytes.fetch_add(size, memory_order_relaxed);
+  int64_t now = live.fetch_add(malloc_usable_size(ptr), memory_order_relaxed) +
+                (int64_t) malloc_usable_size(ptr);
+  int64_t top = peak.load(memory_order_relaxed);
+  while (now > top && !peak.compare_exchange_weak(top, now, memory_order_relaxed)){
+  }
+}
+
+static void noteFree(void* ptr){
+  if (ptr && accounting.load(memory_order_relaxed)){
+    live.fetch_sub(malloc_usable_size(ptr), memory_order_relaxed);
+  }
+}
+
+/* glibc lets a program replace malloc and friends; these forward to the
+ * real allocator. The default operator new and delete call malloc and
+ * free, so C++ allocations are counted here as well. The aligned
+ * allocators are replaced too: their blocks are freed by free(), which
+ * would otherwise subtract bytes that were never added. */
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_calloc(size_t count, size_t size);
+void* __libc_realloc(void* ptr, size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void* __libc_valloc(size_t size);
+void* __libc_pvalloc(size_t size);
+void __libc_free(void* ptr);
+
+void* malloc(size_t size){
+  void* ptr = __libc_malloc(size);
+  noteAlloc(ptr, size);
+  return ptr;
+}
+
+void* calloc(size_t count, size_t size){
+  void* ptr = __libc_calloc(count, size);
+  noteAlloc(ptr, count * size);
+  return ptr;
+}
+
+void* realloc(void* ptr, size_t size){
+  size_t before = ptr ? malloc_usable_size(ptr) : 0;
+  void* moved = __libc_realloc(ptr, size);
+  /* On failure the old block is still live */
+  if ((moved || size == 0) && accounting.load(memory_order_relaxed)){
+    live.fetch_sub(before, memory_order_relaxed);
+  }
+  noteAlloc(moved, size);
+  return moved;
+}
+
+void* memalign(size_t alignment, size_t size){
+  void* ptr = __libc_memalign(alignment, size);
+  noteAlloc(ptr, size);
+  return ptr;
+}
+
+void* aligned_alloc(size_t alignment, size_t size){
+  return memalign(alignment, size);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size){
+  if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0){
+    return EINVAL;
+  }
+  void* ptr = memalign(alignment, size);
+  if (!ptr && size != 0){
+    return ENOMEM;
+  }
+  *result = ptr;
+  return 0;
+}
+
+void* valloc(size_t size){
+  void* ptr = __libc_valloc(size);
+  noteAlloc(ptr, size);
+  return ptr;
+}
+
+void* pvalloc(size_t size){
+  void* ptr = __libc_pvalloc(size);
+  noteAlloc(ptr, size);
+  return ptr;
+}
+
+void free(void* ptr){
+  noteFree(ptr);
+  __libc_free(ptr);
+}
+}
+#endif
@@ -0,0 +1,337 @@
+#include "bench.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/utsname.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+/* Set by the Makefile to the flags this binary was built with */
+#ifndef BENCH_BUILD_FLAGS
+#define BENCH_BUILD_FLAGS "unknown"
+#endif
+
+static const char* const baselineMagic = "rtesla-bench-baseline 1";
+
+/* CPU model, hardware threads and operating system */
+string benchMachine(){
+  string cpu = "unknown";
+#if defined(__x86_64__) || defined(__i386__)
+  unsigned int regs[12];
+  if (__get_cpuid_max(0x80000000, NULL) >= 0x80000004){
+    for (unsigned int i = 0; i < 3; i++){
+      __cpuid(0x80000002 + i, regs[4 * i], regs[4 * i + 1], regs[4 * i + 2], regs[4 * i + 3]);
+    }
+    string brand((const char*) regs, sizeof(regs));
+    brand = brand.substr(0, brand.find('\0'));
+    size_t first = brand.find_first_not_of(' ');
+    if (first != string::npos){
+      cpu = brand.substr(first);
+    }
+  }
+#endif
+  ostringstream out;
+  out << "cpu: " << cpu << ", threads: " << thread::hardware_concurrency();
+#if defined(__unix__) || defined(__APPLE__)
+  struct utsname name;
+  if (uname(&name) == 0){
+    out << ", os: " << name.sysname << " " << name.release << " " << name.machine;
+  }
+#endif
+  return out.str();
+}
+
+string benchBuild(){
+#if defined(__VERSION__)
+  return string("compiler: ") + __VERSION__ + ", flags: " + BENCH_BUILD_FLAGS;
+#else
+  return string("flags: ") + BENCH_BUILD_FLAGS;
+#endif
+}
+
+/* Line-oriented and tab-separated, since operation names contain spaces:
+ *   rtesla-bench-baseline 1
+ *   name / machine / build <TAB> text
+ *   parameter <TAB> key <TAB> value
+ *   result <TAB> name <TAB> threads <TAB> items per op <TAB> failures
+ *   run <TAB> wall ns (0 if single-threaded) <TAB> samples in ns, space-separated
+ *   alloc <TAB> allocations <TAB> bytes <TAB> peak bytes <TAB> attempts, per op
+ * with each result followed by its runs and, if counted, its heap use. */
+bool benchSaveBaseline(BenchReport& report, const string& path, const string& name){
+  ofstream out(path.c_str());
+  out << baselineMagic << endl
+      << "name\t" << name << endl
+      << "machine\t" << benchMachine() << endl
+      << "build\t" << benchBuild() << endl;
+  const BenchConfig& config = report.benchConfig();
+  out << "parameter\truns\t" << config.runs << endl
+      << "parameter\titerations\t" << config.iterations << endl
+      << "parameter\twarmup\t" << config.warmup << endl;
+  const vector<pair<string, string> >& parameters = report.parameterList();
+  for (unsigned int i = 0; i < parameters.size(); i++){
+    out << "parameter\t" << parameters[i].first << "\t" << parameters[i].second << endl;
+  }
+  out << fixed << setprecision(1);
+  vector<BenchResult>& results = report.results();
+  for (unsigned int i = 0; i < results.size(); i++){
+    const BenchResult& r = results[i];
+    out << "result\t" << r.name << "\t" << r.threads << "\t" << r.itemsPerOp << "\t"
+        << r.failures << endl;
+    for (unsigned int k = 0; k < r.runs.size(); k++){
+      out << "run\t" << (k < r.wallNs.size() ? r.wallNs[k] : 0) << "\t";
+      for (unsigned int j = 0; j < r.runs[k].size(); j++){
+        out << (j ? " " : "") << r.runs[k][j];
+      }
+      out << endl;
+    }
+    if (r.hasAllocs()){
+      out << "alloc\t" << r.allocsPerOp << "\t" << r.allocBytesPerOp << "\t"
+          << r.allocPeakBytes << "\t" << setprecision(3) << r.attemptsPerOp
+          << setprecision(1) << endl;
+    }
+  }
+  if (!out){
+    cerr << "could not write " << path << endl;
+    return false;
+  }
+  return true;
+}
+
+static vector<string> splitTabs(const string& line){
+  vector<string> fields;
+  size_t start = 0;
+  size_t tab;
+  while ((tab = line.find('\t', start)) != string::npos){
+    fields.push_back(line.substr(start, tab - start));
+    start = tab + 1;
+  }
+  fields.push_back(line.substr(start));
+  return fields;
+}
+
+bool benchLoadBaseline(const string& path, BenchBaseline& baseline){
+  ifstream in(path.c_str());
+  string line;
+  if (!getline(in, line) || line != baselineMagic){
+    cerr << path << ": not a benchmark baseline" << endl;
+    return false;
+  }
+  unsigned int number = 0;
+  while (getline(in, line)){
+    vector<string> fields = splitTabs(line);
+    const string& kind = fields[0];
+    if (kind == "name" && fields.size() == 2){
+      baseline.name = fields[1];
+    } else if (kind == "machine" && fields.size() == 2){
+      baseline.machine = fields[1];
+    } else if (kind == "build" && fields.size() == 2){
+      baseline.build = fields[1];
+    } else if (kind == "parameter" && fields.size() == 3){
+      baseline.parameters.push_back(make_pair(fields[1], fields[2]));
+    } else if (kind == "result" && fields.size() == 5 && benchParseUnsigned(fields[2], number)){
+      BenchResult result;
+      result.name = fields[1];
+      result.threads = number;
+      benchParseUnsigned(fields[3], result.itemsPerOp);
+      benchParseUnsigned(fields[4], result.failures);
+      baseline.results.push_back(result);
+    } else if (kind == "run" && fields.size() == 3 && !baseline.results.empty()){
+      BenchResult& result = baseline.results.back();
+      double wall = strtod(fields[1].c_str(), NULL);
+      if (wall > 0){
+        result.wallNs.resize(result.runs.size());
+        result.wallNs.push_back(wall);
+      }
+      istringstream samples(fields[2]);
+      result.runs.push_back(vector<double>());
+      double sample;
+      while (samples >> sample){
+        result.runs.back().push_back(sample);
+      }
+    } else if (kind == "alloc" && fields.size() == 5 && !baseline.results.empty()){
+      BenchResult& result = baseline.results.back();
+      result.allocsPerOp = strtod(fields[1].c_str(), NULL);
+      result.allocBytesPerOp = strtod(fields[2].c_str(), NULL);
+      result.allocPeakBytes = strtod(fields[3].c_str(), NULL);
+      result.attemptsPerOp = strtod(fields[4].c_str(), NULL);
+    } else {
+      cerr << path << ": malformed line: " << line.substr(0, 60) << endl;
+      return false;
+    }
+  }
+  for (unsigned int i = 0; i < baseline.results.size(); i++){
+    baseline.results[i].summarize();
+  }
+  return true;
+}
+
+/* One-sided Mann-Whitney U test with the normal approximation, corrected
+ * for ties. Returns the p-value for "after tends to be larger than before";
+ * one minus it (near enough) is the p-value for the other direction. */
+static double rankSumSlower(const BenchResult& before, const BenchResult& after){
+  vector<pair<double, int> > all;
+  for (unsigned int r = 0; r < before.runs.size(); r++){
+    for (unsigned int i = 0; i < before.runs[r].size(); i++){
+      all.push_back(make_pair(before.runs[r][i], 0));
+    }
+  }
+  for (unsigned int r = 0; r < after.runs.size(); r++){
+    for (unsigned int i = 0; i < after.runs[r].size(); i++){
+      all.push_back(make_pair(after.runs[r][i], 1));
+    }
+  }
+  double n = all.size();
+  double nAfter = 0;
+  for (unsigned int i = 0; i < all.size(); i++){
+    nAfter += all[i].second;
+  }
+  double nBefore = n - nAfter;
+  if (nBefore == 0 || nAfter == 0){
+    return 1;
+  }
+  sort(all.begin(), all.end());
+  double rankAfter = 0;
+  double ties = 0;
+  for (size_t i = 0; i < all.size();){
+    size_t j = i;
+    while (j < all.size() && all[j].first == all[i].first){
+      j++;
+    }
+    double rank = (i + 1 + j) / 2.0; /* average of ranks i+1 .. j */
+    for (size_t k = i; k < j; k++){
+      rankAfter += all[k].second ? rank : 0;
+    }
+    double t = j - i;
+    ties += t * t * t - t;
+    i = j;
+  }
+  double u = rankAfter - nAfter * (nAfter + 1) / 2;
+  double mean = nBefore * nAfter / 2;
+  double var = nBefore * nAfter / 12 * ((n + 1) - ties / (n * (n - 1)));
+  if (var <= 0){
+    return 0.5;
+  }
+  double z = (u - mean - 0.5) / sqrt(var);
+  return 0.5 * erfc(z / sqrt(2.0));
+}
+
+static const BenchResult* findResult(const BenchBaseline& baseline, const BenchResult& now){
+  for (unsigned int k = 0; k < baseline.results.size(); k++){
+    if (baseline.results[k].name == now.name && baseline.results[k].threads == now.threads){
+      return &baseline.results[k];
+    }
+  }
+  return NULL;
+}
+
+/* Heap use is deterministic per call, so any growth beyond the threshold
+ * counts; there is no noise to test against. Returns the regressions. */
+static unsigned int compareAllocs(const vector<BenchResult>& results,
+                                  const BenchBaseline& baseline, double threshold,
+                                  size_t width, ostream& out){
+  bool any = false;
+  for (unsigned int i = 0; i < results.size(); i++){
+    const BenchResult* before = findResult(baseline, results[i]);
+    any = any || (before && before->hasAllocs() && results[i].hasAllocs());
+  }
+  if (!any){
+    return 0;
+  }
+  out << endl << left << setw(width + 2) << "heap" << right << setw(8) << "threads"
+      << setw(12) << "allocs/op" << setw(12) << "bytes/op" << setw(12) << "peak B"
+      << setw(11) << "verdict" << endl;
+  out << string(width + 2 + 8 + 12 * 3 + 11, '-') << endl;
+  unsigned int regressions = 0;
+  for (unsigned int i = 0; i < results.size(); i++){
+    const BenchResult& now = results[i];
+    const BenchResult* before = findResult(baseline, now);
+    if (!before || !before->hasAllocs() || !now.hasAllocs()){
+      continue;
+    }
+    /* Sign attempts depend on the messages, so compare per attempt there */
+    bool perAttempt = before->attemptsPerOp > 0 && now.attemptsPerOp > 0;
+    double wasAttempts = perAttempt ? before->attemptsPerOp : 1;
+    double isAttempts = perAttempt ? now.attemptsPerOp : 1;
+    const double was[3] = {before->allocsPerOp / wasAttempts,
+                           before->allocBytesPerOp / wasAttempts, before->allocPeakBytes};
+    const double is[3] = {now.allocsPerOp / isAttempts, now.allocBytesPerOp / isAttempts,
+                          now.allocPeakBytes};
+    const char* const metrics[3] = {"allocs", "bytes", "peak"};
+    string verdict = "ok";
+    out << left << setw(width + 2) << now.name << right << setw(8) << now.threads;
+    for (int m = 0; m < 3; m++){
+      double change = was[m] > 0 ? 100 * (is[m] - was[m]) / was[m] : (is[m] > 0 ? 100 : 0);
+      ostringstream percent;
+      percent << fixed << setprecision(1) << showpos << change << "%";
+      out << setw(12) << percent.str();
+      if (change > threshold){
+        verdict = verdict == "ok" ? string("MORE ") + metrics[m] : verdict + "," + metrics[m];
+      }
+    }
+    out << "  " << verdict << (perAttempt ? " (per attempt)" : "") << endl;
+    regressions += verdict != "ok";
+  }
+  return regressions;
+}
+
+bool benchCompare(BenchReport& report, const BenchBaseline& baseline, double threshold,
+                  double alpha, ostream& out){
+  out << "baseline: " << baseline.name << endl;
+  string machine = benchMachine();
+  string build = benchBuild();
+  if (baseline.machine != machine){
+    out << "warning: baseline machine differs" << endl
+        << "  was: " << baseline.machine << endl << "  now: " << machine << endl;
+  }
+  if (baseline.build != build){
+    out << "warning: baseline build differs" << endl
+        << "  was: " << baseline.build << endl << "  now: " << build << endl;
+  }
+
+  vector<BenchResult>& results = report.results();
+  size_t width = 9;
+  for (unsigned int i = 0; i < results.size(); i++){
+    width = std::max(width, results[i].name.size());
+  }
+  out << left << setw(width + 2) << "operation" << right << setw(8) << "threads"
+      << setw(14) << "base p50 us" << setw(14) << "new p50 us" << setw(10) << "change"
+      << setw(11) << "p-value" << setw(11) << "verdict" << endl;
+  out << string(width + 2 + 8 + 14 * 2 + 10 + 11 * 2, '-') << endl;
+  unsigned int regressions = 0;
+  for (unsigned int i = 0; i < results.size(); i++){
+    const BenchResult& now = results[i];
+    const BenchResult* before = findResult(baseline, now);
+    out << left << setw(width + 2) << now.name << right << setw(8) << now.threads << fixed;
+    if (!before || before->p50 <= 0){
+      out << setw(14) << "-" << setprecision(3) << setw(14) << now.p50 / 1e3
+          << setw(10) << "-" << setw(11) << "-" << setw(11) << "new" << endl;
+      continue;
+    }
+    double change = 100 * (now.p50 - before->p50) / before->p50;
+    double pSlower = rankSumSlower(*before, now);
+    double p = change > 0 ? pSlower : 1 - pSlower;
+    string verdict = "ok";
+    if (change > threshold && p < alpha){
+      verdict = "REGRESSED";
+      regressions++;
+    } else if (-change > threshold && p < alpha){
+      verdict = "faster";
+    }
+    ostringstream percent;
+    percent << fixed << setprecision(1) << showpos << change << "%";
+    out << setprecision(3) << setw(14) << before->p50 / 1e3 << setw(14) << now.p50 / 1e3
+        << setw(10) << percent.str() << setprecision(4) << setw(11) << p
+        << setw(11) << verdict << endl;
+  }
+  regressions += compareAllocs(results, baseline, threshold, width, out);
+  out << defaultfloat << setprecision(6) << regressions << " regression(s) beyond "
+      << threshold << "% at alpha " << alpha << endl;
+  return regressions > 0;
+}
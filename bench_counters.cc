@@ -0,0 +1,111 @@
+#include "bench.h"
+#include <cerrno>
+#include <cstring>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define BENCH_HAVE_PERF 1
+#else
+#define BENCH_HAVE_PERF 0
+#endif
+
+string BenchCounters::lastStatus = "not tried";
+
+const char* BenchCounters::name(Event event){
+  static const char* const names[EVENTS] = {"cycles", "instructions", "l1d_misses",
+                                            "llc_misses", "branch_misses"};
+  return names[event];
+}
+
+#if BENCH_HAVE_PERF
+static int perfOpen(uint32_t type, uint64_t config, int group){
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = group < 0; /* members follow the leader */
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return (int) syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+#endif
+
+/* Cycles lead the group; the other events join it if the PMU has them */
+BenchCounters::BenchCounters() : leader(-1){
+  for (int e = 0; e < EVENTS; e++){
+    fds[e] = -1;
+    slot[e] = -1;
+  }
+#if BENCH_HAVE_PERF
+  const uint32_t types[EVENTS] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE,
+                                  PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE};
+  const uint64_t configs[EVENTS] = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+          (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+  int opened = 0;
+  for (int e = 0; e < EVENTS; e++){
+    fds[e] = perfOpen(types[e], configs[e], leader);
+    if (e == CYCLES && fds[e] < 0){
+      lastStatus = string("unavailable (perf_event_open: ") + strerror(errno) + ")";
+      return;
+    }
+    if (fds[e] >= 0){
+      slot[e] = opened++;
+    }
+    if (e == CYCLES){
+      leader = fds[e];
+    }
+  }
+  lastStatus = "on";
+#else
+  lastStatus = "unavailable (needs Linux perf_event_open)";
+#endif
+}
+
+BenchCounters::~BenchCounters(){
+#if BENCH_HAVE_PERF
+  for (int e = 0; e < EVENTS; e++){
+    if (fds[e] >= 0){
+      close(fds[e]);
+    }
+  }
+#endif
+}
+
+void BenchCounters::start(){
+#if BENCH_HAVE_PERF
+  if (leader >= 0){
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  }
+#endif
+}
+
+void BenchCounters::stop(double totals[EVENTS]){
+#if BENCH_HAVE_PERF
+  if (leader < 0){
+    return;
+  }
+  ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+  /* nr, time enabled, time running, then one value per member */
+  uint64_t data[3 + EVENTS];
+  if (read(leader, data, sizeof(data)) < (ssize_t) (3 * sizeof(uint64_t)) || data[2] == 0){
+    return;
+  }
+  double scale = (double) data[1] / (double) data[2];
+  for (int e = 0; e < EVENTS; e++){
+    if (slot[e] >= 0 && (uint64_t) slot[e] < data[0]){
+      totals[e] = max(totals[e], 0.0) + scale * data[3 + slot[e]];
+    }
+  }
+#else
+  (void) totals;
+#endif
+}
@@ -0,0 +1,107 @@
+#!/usr/bin/env python
+
+# Generates fixed-base.inc: for every curve, the affine points
+# (2j + 1) * 16^i * G for j = 0..7 and every 4-bit window i of the curve
+# order, as used by EccPoint_mult_fixed_base() in uECC.c.
+#
+#   python scripts/fixed_base.py > fixed-base.inc
+
+WINDOW_BITS = 4
+ENTRIES = 1 << (WINDOW_BITS - 1)
+
+# name: (p, a, b, n, Gx, Gy, coordinate bytes)
+CURVES = [
+    ("secp160r1",
+     0xffffffffffffffffffffffffffffffff7fffffff, -3,
+     0x1c97befc54bd7a8b65acf89f81d4d4adc565fa45,
+     0x100000000000000000001f4c8f927aed3ca752257,
+     0x4a96b5688ef573284664698968c38bb913cbfc82,
+     0x23a628553168947d59dcc912042351377ac5fb32, 20),
+    ("secp192r1",
+     0xfffffffffffffffffffffffffffffffeffffffffffffffff, -3,
+     0x64210519e59c80e70fa7e9ab72243049feb8deecc146b9b1,
+     0xffffffffffffffffffffffff99def836146bc9b1b4d22831,
+     0x188da80eb03090f67cbf20eb43a18800f4ff0afd82ff1012,
+     0x07192b95ffc8da78631011ed6b24cdd573f977a11e794811, 24),
+    ("secp224r1",
+     0xffffffffffffffffffffffffffffffff000000000000000000000001, -3,
+     0xb4050a850c04b3abf54132565044b0b7d7bfd8ba270b39432355ffb4,
+     0xffffffffffffffffffffffffffff16a2e0b8f03e13dd29455c5c2a3d,
+     0xb70e0cbd6bb4bf7f321390b94a03c1d356c21122343280d6115c1d21,
+     0xbd376388b5f723fb4c22dfe6cd4375a05a07476444d5819985007e34, 28),
+    ("secp256r1",
+     0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff, -3,
+     0x5ac635d8aa3a93e7b3ebbd55769886bc651d06b0cc53b0f63bce3c3e27d2604b,
+     0xffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632551,
+     0x6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296,
+     0x4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5, 32),
+    ("secp256k1",
+     0xfffffffffffffffffffffffffffffffffffffffffffffffffffffffefffffc2f, 0, 7,
+     0xfffffffffffffffffffffffffffffffebaaedce6af48a03bbfd25e8cd0364141,
+     0x79be667ef9dcbbac55a06295ce870b07029bfcdb2dce28d959f2815b16f81798,
+     0x483ada7726a3c4655da4fbfc0e1108a8fd17b448a68554199c47d08ffb10d4b8, 32),
+]
+
+def inverse(x, p):
+    return pow(x, p - 2, p)
+
+def add(P, Q, p, a):
+    if P is None:
+        return Q
+    if Q is None:
+        return P
+    if P[0] == Q[0]:
+        if (P[1] + Q[1]) % p == 0:
+            return None
+        l = (3 * P[0] * P[0] + a) * inverse(2 * P[1], p) % p
+    else:
+        l = (Q[1] - P[1]) * inverse(Q[0] - P[0], p) % p
+    x = (l * l - P[0] - Q[0]) % p
+    return (x, (l * (P[0] - x) - P[1]) % p)
+
+def mult(k, P, p, a):
+    R = None
+    while k:
+        if k & 1:
+            R = add(R, P, p, a)
+        P = add(P, P, p, a)
+        k >>= 1
+    return R
+
+def words(value, num_bytes):
+    """BYTES_TO_WORDS_8/_4 groups, least significant byte first"""
+    data = [(value >> (8 * i)) & 0xff for i in range(num_bytes)]
+    groups = []
+    for i in range(0, num_bytes, 8):
+        chunk = data[i:i + 8]
+        groups.append("BYTES_TO_WORDS_%d(%s)" % (len(chunk), ", ".join("%02X" % b for b in chunk)))
+    return ", ".join(groups)
+
+print("/* Generated by scripts/fixed_base.py; do not edit. */")
+print("")
+print("#ifndef _UECC_FIXED_BASE_H_")
+print("#define _UECC_FIXED_BASE_H_")
+for name, p, a, b, n, gx, gy, num_bytes in CURVES:
+    G = (gx, gy)
+    assert (gy * gy - gx * gx * gx - a * gx - b) % p == 0
+    assert mult(n, G, p, a) is None
+    windows = (n.bit_length() + WINDOW_BITS - 1) // WINDOW_BITS
+    print("")
+    print("#if uECC_SUPPORTS_%s" % name)
+    print("static const uECC_word_t fixed_base_%s[%d * %d * 2 * num_words_%s] = {"
+          % (name, windows, ENTRIES, name))
+    base = G
+    for i in range(windows):
+        print("    /* (2j + 1) * 16^%d * G */" % i)
+        P = base
+        twice = add(base, base, p, a)
+        for j in range(ENTRIES):
+            print("    %s," % words(P[0], num_bytes))
+            print("    %s," % words(P[1], num_bytes))
+            P = add(P, twice, p, a)
+        for k in range(WINDOW_BITS):
+            base = add(base, base, p, a)
+    print("};")
+    print("#endif /* uECC_SUPPORTS_%s */" % name)
+print("")
+print("#endif /* _UECC_FIXED_BASE_H_ */")
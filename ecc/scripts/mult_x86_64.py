@@ -0,0 +1,120 @@
+#!/usr/bin/env python
+
+# Generates asm_x86_64_mult_square.inc: fully unrolled multiplication and squaring of 3- and
+# 4-word (64-bit) numbers with MULX, ADCX and ADOX, as used by asm_x86_64.inc.
+#
+#   python scripts/mult_x86_64.py > asm_x86_64_mult_square.inc
+#
+# The code expects result in rdi, left in rsi and (for multiplication) right in rcx, and
+# clobbers rax, rbx, rdx, r8 - r13 and, for squaring, rcx, r14 and r15. ADCX and ADOX only
+# touch the carry and the overflow flag, so each row adds the low and the high halves of its
+# products in two independent carry chains.
+
+SIZES = [3, 4]
+
+def reg(i):
+    return "%r" + str(8 + i)
+
+def mult(n):
+    A = lambda p: reg(p % (n + 1))
+    lines = []
+    emit = lines.append
+
+    # first row: left[0] * right, with a plain carry chain
+    emit("movq 0(%rsi), %rdx")
+    emit("mulxq 0(%rcx), {0}, {1}".format(A(0), A(1)))
+    for j in range(1, n):
+        emit("mulxq {0}(%rcx), %rax, {1}".format(8 * j, A(j + 1)))
+        emit("{0} %rax, {1}".format("addq" if j == 1 else "adcq", A(j)))
+    emit("adcq $0, {0}".format(A(n)))
+    emit("movq {0}, 0(%rdi)".format(A(0)))
+
+    # the other rows; the register of the word just stored takes the new top word
+    for i in range(1, n):
+        emit("")
+        emit("movq {0}(%rsi), %rdx".format(8 * i))
+        emit("xorl %r13d, %r13d")
+        for j in range(n - 1):
+            emit("mulxq {0}(%rcx), %rax, %rbx".format(8 * j))
+            emit("adcxq %rax, {0}".format(A(i + j)))
+            emit("adoxq %rbx, {0}".format(A(i + j + 1)))
+        emit("mulxq {0}(%rcx), %rax, {1}".format(8 * (n - 1), A(i + n)))
+        emit("adcxq %rax, {0}".format(A(i + n - 1)))
+        emit("adoxq %r13, {0}".format(A(i + n)))
+        emit("adcxq %r13, {0}".format(A(i + n)))
+        emit("movq {0}, {1}(%rdi)".format(A(i), 8 * i))
+
+    emit("")
+    for p in range(n, 2 * n):
+        emit("movq {0}, {1}(%rdi)".format(A(p), 8 * p))
+    return lines
+
+def square(n):
+    S = reg
+    lines = []
+    emit = lines.append
+
+    # products left[i] * left[j] for i < j
+    emit("movq 0(%rsi), %rdx")
+    emit("mulxq 8(%rsi), {0}, {1}".format(S(1), S(2)))
+    for j in range(2, n):
+        emit("mulxq {0}(%rsi), %rax, {1}".format(8 * j, S(j + 1)))
+        emit("{0} %rax, {1}".format("addq" if j == 2 else "adcq", S(j)))
+    if n > 2:
+        emit("adcq $0, {0}".format(S(n)))
+
+    for i in range(1, n - 1):
+        emit("")
+        emit("movq {0}(%rsi), %rdx".format(8 * i))
+        emit("xorl %ecx, %ecx")
+        for j in range(i + 1, n - 1):
+            emit("mulxq {0}(%rsi), %rax, %rbx".format(8 * j))
+            emit("adcxq %rax, {0}".format(S(i + j)))
+            emit("adoxq %rbx, {0}".format(S(i + j + 1)))
+        emit("mulxq {0}(%rsi), %rax, {1}".format(8 * (n - 1), S(i + n)))
+        emit("adcxq %rax, {0}".format(S(i + n - 1)))
+        emit("adoxq %rcx, {0}".format(S(i + n)))
+        emit("adcxq %rcx, {0}".format(S(i + n)))
+
+    # double them (carry chain) while adding the squares left[i]^2 (overflow chain)
+    emit("")
+    emit("xorl %ecx, %ecx")
+    emit("movq %rcx, {0}".format(S(2 * n - 1)))
+    emit("movq 0(%rsi), %rdx")
+    emit("mulxq %rdx, {0}, %rax".format(S(0)))
+    emit("adcxq {0}, {0}".format(S(1)))
+    emit("adoxq %rax, {0}".format(S(1)))
+    for i in range(1, n):
+        emit("movq {0}(%rsi), %rdx".format(8 * i))
+        emit("mulxq %rdx, %rax, %rbx")
+        emit("adcxq {0}, {0}".format(S(2 * i)))
+        emit("adoxq %rax, {0}".format(S(2 * i)))
+        emit("adcxq {0}, {0}".format(S(2 * i + 1)))
+        emit("adoxq %rbx, {0}".format(S(2 * i + 1)))
+
+    emit("")
+    for p in range(2 * n):
+        emit("movq {0}, {1}(%rdi)".format(S(p), 8 * p))
+    return lines
+
+def define(name, lines):
+    text = [('"' + l.replace("%", "%%") + r' \n\t"') if l else "" for l in lines]
+    width = max(len(t) for t in text) + 6
+    print("#define " + name + " " * (width - len(name) - 8) + "\\")
+    for i, t in enumerate(text):
+        if i == len(text) - 1:
+            print("    " + t)
+        else:
+            print(("    " + t).ljust(width) + "\\")
+    print("")
+
+print("/* Generated by scripts/mult_x86_64.py; do not edit. */")
+print("")
+print("#ifndef _UECC_ASM_X86_64_MULT_SQUARE_H_")
+print("#define _UECC_ASM_X86_64_MULT_SQUARE_H_")
+print("")
+for n in SIZES:
+    define("FAST_MULT_ASM_%d" % n, mult(n))
+for n in SIZES:
+    define("FAST_SQUARE_ASM_%d" % n, square(n))
+print("#endif /* _UECC_ASM_X86_64_MULT_SQUARE_H_ */")
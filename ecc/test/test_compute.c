@@ -13,12 +13,25 @@ void vli_print(char *str, uint8_t *vli, unsigned int size) {
     printf("\n");
 }
 
+#define NUM_BATCH_KEYS 21
+
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+#include "types.h"
+/* Batch keys are native word arrays in this mode; see uECC_make_keys_batch(). */
+#define KEY_STRIDE(size) (((size) + uECC_WORD_SIZE - 1) / uECC_WORD_SIZE * uECC_WORD_SIZE)
+#else
+#define KEY_STRIDE(size) (size)
+#endif
+
 int main() {
     int i;
     int success;
     uint8_t private[32];
     uint8_t public[64];
     uint8_t public_computed[64];
+    uint8_t privates[NUM_BATCH_KEYS * 32];
+    uint8_t publics[NUM_BATCH_KEYS * 64];
+    int private_size, public_size;
     
     int c;
     
@@ -75,6 +88,30 @@ int main() {
             printf("uECC_compute_public_key() should have failed\n");
         }
         printf("\n");
+
+        printf("Testing %d batch key pairs\n", NUM_BATCH_KEYS);
+        /* The keys are packed back to back */
+        private_size = KEY_STRIDE(uECC_curve_private_key_size(curves[c]));
+        public_size = 2 * KEY_STRIDE(uECC_curve_public_key_size(curves[c]) / 2);
+        if (!uECC_make_keys_batch(NUM_BATCH_KEYS, publics, privates, curves[c])) {
+            printf("uECC_make_keys_batch() failed\n");
+            return 1;
+        }
+        for (i = 0; i < NUM_BATCH_KEYS; ++i) {
+            memset(public_computed, 0, sizeof(public_computed));
+            if (!uECC_compute_public_key(privates + i * private_size, public_computed,
+                                         curves[c])) {
+                printf("uECC_compute_public_key() failed\n");
+                return 1;
+            }
+            if (memcmp(publics + i * public_size, public_computed, public_size) != 0) {
+                printf("Computed and batch public keys are not identical!\n");
+                vli_print("Computed public key = ", public_computed, public_size);
+                vli_print("Batch public key = ", publics + i * public_size, public_size);
+                return 1;
+            }
+        }
+        printf("\n");
     }
     
     return 0;
@@ -5,12 +5,23 @@
 #include <stdio.h>
 #include <string.h>
 
+#define NUM_BATCH_KEYS 3
+#define NUM_BATCH_SIGNATURES 21
+
 int main() {
     int i, c;
     uint8_t private[32] = {0};
     uint8_t public[64] = {0};
     uint8_t hash[32] = {0};
     uint8_t sig[64] = {0};
+    uECC_PreparedKey prepared;
+    uECC_PreparedKey batch_keys[NUM_BATCH_KEYS];
+    const uECC_PreparedKey *keys[NUM_BATCH_SIGNATURES];
+    uint8_t privates[NUM_BATCH_KEYS][32] = {{0}};
+    uint8_t hashes[NUM_BATCH_SIGNATURES][32] = {{0}};
+    uint8_t sigs[NUM_BATCH_SIGNATURES * 64] = {0};
+    uint8_t valid[NUM_BATCH_SIGNATURES];
+    int sig_size;
 
     const struct uECC_Curve_t * curves[5];
     int num_curves = 0;
@@ -51,9 +62,67 @@ int main() {
                 printf("uECC_verify() failed\n");
                 return 1;
             }
+
+            if (!uECC_prepare_public_key(public, &prepared, curves[c])) {
+                printf("uECC_prepare_public_key() failed\n");
+                return 1;
+            }
+
+            if (!uECC_verify_prepared(&prepared, hash, sizeof(hash), sig)) {
+                printf("uECC_verify_prepared() failed\n");
+                return 1;
+            }
+
+            hash[i % 16] ^= 0x80;
+            if (uECC_verify_prepared(&prepared, hash, sizeof(hash), sig)) {
+                printf("uECC_verify_prepared() accepted a wrong hash\n");
+                return 1;
+            }
         }
         printf("\n");
     }
-    
+
+    printf("Testing batch verification\n");
+    for (c = 0; c < num_curves; ++c) {
+        /* Signatures are packed back to back, r and s each the size of a coordinate. */
+        sig_size = uECC_curve_public_key_size(curves[c]);
+        for (i = 0; i < NUM_BATCH_KEYS; ++i) {
+            if (!uECC_make_key(public, privates[i], curves[c]) ||
+                    !uECC_prepare_public_key(public, &batch_keys[i], curves[c])) {
+                printf("uECC_make_key() failed\n");
+                return 1;
+            }
+        }
+        for (i = 0; i < NUM_BATCH_SIGNATURES; ++i) {
+            keys[i] = &batch_keys[i % NUM_BATCH_KEYS];
+            hashes[i][0] = (uint8_t)i;
+            if (!uECC_sign(privates[i % NUM_BATCH_KEYS], hashes[i], sizeof(hashes[i]), sigs + i * sig_size,
+                           curves[c])) {
+                printf("uECC_sign() failed\n");
+                return 1;
+            }
+        }
+        /* Every fifth signature is made invalid: a wrong hash, or s out of range. */
+        for (i = 0; i < NUM_BATCH_SIGNATURES; i += 5) {
+            if (i % 10) {
+                hashes[i][1] ^= 0x80;
+            } else {
+                memset(sigs + i * sig_size + sig_size / 2, 0xff, sig_size / 2);
+            }
+        }
+
+        if (uECC_verify_batch(keys, hashes[0], sizeof(hashes[0]), sigs,
+                              NUM_BATCH_SIGNATURES, valid) != NUM_BATCH_SIGNATURES - 5) {
+            printf("uECC_verify_batch() failed\n");
+            return 1;
+        }
+        for (i = 0; i < NUM_BATCH_SIGNATURES; ++i) {
+            if (valid[i] != (i % 5 != 0)) {
+                printf("uECC_verify_batch() got signature %d wrong\n", i);
+                return 1;
+            }
+        }
+    }
+
     return 0;
 }
@@ -0,0 +1,118 @@
+/* Build uECC.c and this file with -DuECC_ENABLE_VLI_API=1; otherwise this test is skipped. */
+#include "uECC_vli.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#if uECC_ENABLE_VLI_API
+
+#define MAX_BATCH 17
+#define MAX_WORDS (32 / sizeof(uECC_word_t)) /* enough for n of secp160r1 too */
+#define NUM_ROUNDS 8
+
+/* Lane counts to test: every partial group of the 8 IFMA lanes, a full one and one more,
+   and a count that leaves a single lane in a third group. */
+static const unsigned counts[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 17};
+
+void vli_print(const char *str, const uECC_word_t *vli, unsigned num_words) {
+    unsigned i;
+    printf("%s ", str);
+    for (i = num_words; i-- > 0; ) {
+        printf("%0*llX ", (int)(2 * sizeof(uECC_word_t)), (unsigned long long)vli[i]);
+    }
+    printf("\n");
+}
+
+int main() {
+    uECC_word_t points[MAX_BATCH * 2 * MAX_WORDS];
+    uECC_word_t scalars[MAX_BATCH * MAX_WORDS];
+    uECC_word_t results[MAX_BATCH * 2 * MAX_WORDS];
+    uECC_word_t expected[2 * MAX_WORDS];
+    uECC_word_t k[MAX_WORDS];
+    unsigned num_words, num_n_words;
+    unsigned i, j, round;
+    int c;
+
+    const struct uECC_Curve_t * curves[5];
+    int num_curves = 0;
+#if uECC_SUPPORTS_secp160r1
+    curves[num_curves++] = uECC_secp160r1();
+#endif
+#if uECC_SUPPORTS_secp192r1
+    curves[num_curves++] = uECC_secp192r1();
+#endif
+#if uECC_SUPPORTS_secp224r1
+    curves[num_curves++] = uECC_secp224r1();
+#endif
+#if uECC_SUPPORTS_secp256r1
+    curves[num_curves++] = uECC_secp256r1();
+#endif
+#if uECC_SUPPORTS_secp256k1
+    curves[num_curves++] = uECC_secp256k1();
+#endif
+
+    printf("Testing uECC_point_mult_batch() against uECC_point_mult()\n");
+    for (c = 0; c < num_curves; ++c) {
+        num_words = uECC_curve_num_words(curves[c]);
+        num_n_words = uECC_curve_num_n_words(curves[c]);
+        for (round = 0; round < NUM_ROUNDS; ++round) {
+            for (i = 0; i < sizeof(counts) / sizeof(counts[0]); ++i) {
+                unsigned count = counts[i];
+                printf(".");
+                fflush(stdout);
+
+                /* Random points k * G and random scalars; the ladder of uECC_point_mult()
+                   is only reliable away from the ends of the scalar range, so no edge
+                   values here. */
+                for (j = 0; j < count; ++j) {
+                    if (!uECC_generate_random_int(k, uECC_curve_n(curves[c]), num_n_words) ||
+                            !uECC_generate_random_int(scalars + j * num_n_words,
+                                                      uECC_curve_n(curves[c]), num_n_words)) {
+                        printf("uECC_generate_random_int() failed\n");
+                        return 1;
+                    }
+                    uECC_point_mult(points + j * 2 * num_words, uECC_curve_G(curves[c]), k,
+                                    curves[c]);
+                }
+
+                memset(results, 0, sizeof(results));
+                uECC_point_mult_batch(results, points, scalars, count, curves[c]);
+
+                for (j = 0; j < count; ++j) {
+                    uECC_point_mult(expected, points + j * 2 * num_words,
+                                    scalars + j * num_n_words, curves[c]);
+                    if (memcmp(results + j * 2 * num_words, expected,
+                               2 * num_words * sizeof(uECC_word_t)) != 0) {
+                        printf("Lane %u of %u is wrong!\n", j, count);
+                        vli_print("Point x = ", points + j * 2 * num_words, num_words);
+                        vli_print("Point y = ", points + j * 2 * num_words + num_words,
+                                  num_words);
+                        vli_print("Scalar = ", scalars + j * num_n_words, num_n_words);
+                        vli_print("Batch x = ", results + j * 2 * num_words, num_words);
+                        vli_print("Expected x = ", expected, num_words);
+                        return 1;
+                    }
+                }
+                /* Lanes past count must be left alone. */
+                for (j = count * 2 * num_words; j < MAX_BATCH * 2 * MAX_WORDS; ++j) {
+                    if (results[j] != 0) {
+                        printf("uECC_point_mult_batch() wrote past %u results\n", count);
+                        return 1;
+                    }
+                }
+            }
+        }
+        printf("\n");
+    }
+
+    return 0;
+}
+
+#else
+
+int main() {
+    printf("uECC_ENABLE_VLI_API is off; skipping the uECC_point_mult_batch() test\n");
+    return 0;
+}
+
+#endif /* uECC_ENABLE_VLI_API */
@@ -3,6 +3,14 @@
 #include "uECC.h"
 #include "uECC_vli.h"
 
+/* Phase timers of the enclosing project (make PHASE_TIMING=1); without them uECC builds alone. */
+#if PHASE_TIMING
+    #include "../phase.h"
+#else
+    #define PHASE_BEGIN(t)
+    #define PHASE_END(name, t)
+#endif
+
 #ifndef uECC_RNG_MAX_TRIES
     #define uECC_RNG_MAX_TRIES 64
 #endif
@@ -144,6 +152,7 @@ struct uECC_Curve_t {
     uECC_word_t n[uECC_MAX_WORDS];
     uECC_word_t G[uECC_MAX_WORDS * 2];
     uECC_word_t b[uECC_MAX_WORDS];
+    uECC_word_t n_mu[uECC_MAX_WORDS]; /* See vli_mmod_n() */
     void (*double_jacobian)(uECC_word_t * X1,
                             uECC_word_t * Y1,
                             uECC_word_t * Z1,
@@ -155,6 +164,9 @@ struct uECC_Curve_t {
 #if (uECC_OPTIMIZATION_LEVEL > 0)
     void (*mmod_fast)(uECC_word_t *result, uECC_word_t *product);
 #endif
+#if uECC_FIXED_BASE_TABLES
+    const uECC_word_t *G_table; /* See EccPoint_mult_fixed_base() */
+#endif
 };
 
 #if uECC_VLI_NATIVE_LITTLE_ENDIAN
@@ -181,6 +193,10 @@ static cmpresult_t uECC_vli_cmp_unsafe(const uECC_word_t *left,
     #include "asm_avr.inc"
 #endif
 
+#if (uECC_PLATFORM == uECC_x86_64) && (uECC_WORD_SIZE == 8)
+    #include "asm_x86_64.inc"
+#endif
+
 #if default_RNG_defined
 static uECC_RNG_Function g_rng_function = &default_RNG;
 #else
@@ -417,6 +433,12 @@ uECC_VLI_API void uECC_vli_mult(uECC_word_t *result,
     uECC_word_t r2 = 0;
     wordcount_t i, k;
 
+#if asm_mulx
+    if (vli_mult_mulx(result, left, right, num_words)) {
+        return;
+    }
+#endif
+
     /* Compute each digit of result in sequence, maintaining the carries. */
     for (k = 0; k < num_words; ++k) {
         for (i = 0; i <= k; ++i) {
@@ -499,6 +521,12 @@ uECC_VLI_API void uECC_vli_square(uECC_word_t *result,
 
     wordcount_t i, k;
 
+#if asm_mulx
+    if (vli_square_mulx(result, left, num_words)) {
+        return;
+    }
+#endif
+
     for (k = 0; k < num_words * 2 - 1; ++k) {
         uECC_word_t min = (k < num_words ? 0 : (k + 1) - num_words);
         for (i = min; i <= k && i <= k - i; ++i) {
@@ -559,6 +587,7 @@ uECC_VLI_API void uECC_vli_modSub(uECC_word_t *result,
     }
 }
 
+#if uECC_ENABLE_VLI_API || (uECC_OPTIMIZATION_LEVEL == 0)
 /* Computes result = product % mod, where product is 2N words long. */
 /* Currently only designed to work for curve_p or curve_n. */
 uECC_VLI_API void uECC_vli_mmod(uECC_word_t *result,
@@ -602,8 +631,11 @@ uECC_VLI_API void uECC_vli_mmod(uECC_word_t *result,
     }
     uECC_vli_set(result, v[index], num_words);
 }
+#endif /* uECC_ENABLE_VLI_API || (uECC_OPTIMIZATION_LEVEL == 0) */
 
-/* Computes result = (left * right) % mod. */
+#if uECC_ENABLE_VLI_API
+/* Computes result = (left * right) % mod. For generic moduli; products modulo the curve
+   order use vli_modMult_n(). */
 uECC_VLI_API void uECC_vli_modMult(uECC_word_t *result,
                                    const uECC_word_t *left,
                                    const uECC_word_t *right,
@@ -613,6 +645,7 @@ uECC_VLI_API void uECC_vli_modMult(uECC_word_t *result,
     uECC_vli_mult(product, left, right, num_words);
     uECC_vli_mmod(result, product, mod, num_words);
 }
+#endif /* uECC_ENABLE_VLI_API */
 
 uECC_VLI_API void uECC_vli_modMult_fast(uECC_word_t *result,
                                         const uECC_word_t *left,
@@ -627,6 +660,86 @@ uECC_VLI_API void uECC_vli_modMult_fast(uECC_word_t *result,
 #endif
 }
 
+/* Sets result (result_words long) to vli (vli_words long) >> shift. */
+static void vli_rshift(uECC_word_t *result,
+                       const uECC_word_t *vli,
+                       bitcount_t shift,
+                       wordcount_t vli_words,
+                       wordcount_t result_words) {
+    wordcount_t word_shift = (wordcount_t)(shift / uECC_WORD_BITS);
+    bitcount_t bit_shift = shift % uECC_WORD_BITS;
+    wordcount_t i;
+    for (i = 0; i < result_words; ++i) {
+        wordcount_t j = i + word_shift;
+        uECC_word_t word = (j < vli_words ? vli[j] >> bit_shift : 0);
+        if (bit_shift && j + 1 < vli_words) {
+            word |= vli[j + 1] << (uECC_WORD_BITS - bit_shift);
+        }
+        result[i] = word;
+    }
+}
+
+/* Computes result = product % curve->n, for a product of two numbers below n, by Barrett
+   reduction. With m = num_n_bits and mu = floor(4^m / n):
+       q1 = product >> (m - 1),  q3 = (q1 * mu) >> (m + 1),  r = product - q3 * n
+   where q3 is at most 2 below product / n, so r < 3n and two conditional subtractions finish.
+   mu is in (2^m, 2^(m + 1)), so curve->n_mu holds mu - 2^m, which fits in the words of n, and
+   q3 = (((q1 * n_mu) >> m) + q1) >> 1. That takes two multiplications of num_n_words words
+   instead of uECC_vli_mmod()'s subtraction per bit. The multiplications and additions stay
+   within num_n_words words, as the asm versions require; the extra top word is handled by
+   hand. Constant-time. */
+static void vli_mmod_n(uECC_word_t *result, const uECC_word_t *product, uECC_Curve curve) {
+    uECC_word_t q1[uECC_MAX_WORDS + 1];
+    uECC_word_t a[2 * uECC_MAX_WORDS + 1];
+    uECC_word_t t[2 * uECC_MAX_WORDS];
+    uECC_word_t r[uECC_MAX_WORDS + 1];
+    uECC_word_t *v[2] = {t, r};
+    uECC_word_t mask;
+    uECC_word_t borrow;
+    bitcount_t num_n_bits = curve->num_n_bits;
+    wordcount_t num_n_words = BITS_TO_WORDS(num_n_bits);
+    wordcount_t i;
+
+    /* q1 < 2^(m + 1), so its top word is 0 or 1. */
+    vli_rshift(q1, product, num_n_bits - 1, 2 * num_n_words, num_n_words + 1);
+
+    /* a = q1 * n_mu = low words of q1 * n_mu, plus n_mu shifted up a word if q1's top word is 1. */
+    uECC_vli_mult(a, q1, curve->n_mu, num_n_words);
+    mask = (uECC_word_t)0 - q1[num_n_words];
+    for (i = 0; i < num_n_words; ++i) {
+        t[i] = curve->n_mu[i] & mask;
+    }
+    a[2 * num_n_words] = uECC_vli_add(a + num_n_words, a + num_n_words, t, num_n_words);
+
+    /* r = q3 = ((a >> m) + q1) >> 1, which is at most product / n < 2^m. */
+    vli_rshift(r, a, num_n_bits, 2 * num_n_words + 1, num_n_words + 1);
+    r[num_n_words] += q1[num_n_words] + uECC_vli_add(r, r, q1, num_n_words);
+    uECC_vli_rshift1(r, num_n_words + 1);
+
+    /* r = product - q3 * n, which is below 3n and so fits in num_n_words + 1 words. */
+    uECC_vli_mult(t, r, curve->n, num_n_words);
+    borrow = uECC_vli_sub(r, product, t, num_n_words);
+    r[num_n_words] = product[num_n_words] - t[num_n_words] - borrow;
+
+    for (i = 0; i < 2; ++i) {
+        borrow = uECC_vli_sub(t, r, curve->n, num_n_words);
+        t[num_n_words] = r[num_n_words] - borrow;
+        borrow = (r[num_n_words] < borrow); /* Keep r if r < n */
+        uECC_vli_set(r, v[borrow], num_n_words + 1);
+    }
+    uECC_vli_set(result, r, num_n_words);
+}
+
+/* Computes result = (left * right) % curve->n. */
+static void vli_modMult_n(uECC_word_t *result,
+                          const uECC_word_t *left,
+                          const uECC_word_t *right,
+                          uECC_Curve curve) {
+    uECC_word_t product[2 * uECC_MAX_WORDS];
+    uECC_vli_mult(product, left, right, BITS_TO_WORDS(curve->num_n_bits));
+    vli_mmod_n(result, product, curve);
+}
+
 #if uECC_SQUARE_FUNC
 
 #if uECC_ENABLE_VLI_API
@@ -672,6 +785,231 @@ uECC_VLI_API void uECC_vli_modSquare_fast(uECC_word_t *result,
 
 #endif /* uECC_SQUARE_FUNC */
 
+#if uECC_SAFEGCD_INVERSE
+
+/* Bernstein-Yang inversion, see "Fast constant-time gcd computation and modular inversion".
+   The values are held as signed limbs of SAFEGCD_BITS bits; each round runs SAFEGCD_BITS
+   divsteps on the low limbs only, then applies the resulting 2x2 matrix to the full values. */
+#if (uECC_WORD_SIZE == 8) && SUPPORTS_INT128
+typedef int64_t sg_limb_t;
+typedef uint64_t sg_ulimb_t;
+typedef __int128 sg_wide_t;
+#define SAFEGCD_BITS 62
+#else
+typedef int32_t sg_limb_t;
+typedef uint32_t sg_ulimb_t;
+typedef int64_t sg_wide_t;
+#define SAFEGCD_BITS 30
+#endif
+
+#define SAFEGCD_MASK (((sg_ulimb_t)1 << SAFEGCD_BITS) - 1)
+#define SAFEGCD_SIGN(limb) ((limb) >> (sizeof(sg_limb_t) * 8 - 1))
+#define SAFEGCD_MAX_LIMBS (uECC_MAX_WORDS * uECC_WORD_BITS / SAFEGCD_BITS + 1)
+
+static void safegcd_from_vli(sg_limb_t *limbs,
+                             const uECC_word_t *vli,
+                             wordcount_t num_words,
+                             int num_limbs) {
+    const bitcount_t vli_bits = (bitcount_t)num_words * uECC_WORD_BITS;
+    int i;
+    for (i = 0; i < num_limbs; ++i) {
+        bitcount_t bit = i * SAFEGCD_BITS;
+        bitcount_t done = 0;
+        sg_ulimb_t limb = 0;
+        while (done < SAFEGCD_BITS && bit < vli_bits) {
+            bitcount_t offset = bit & uECC_WORD_BITS_MASK;
+            limb |= (sg_ulimb_t)(vli[bit >> uECC_WORD_BITS_SHIFT] >> offset) << done;
+            done += uECC_WORD_BITS - offset;
+            bit += uECC_WORD_BITS - offset;
+        }
+        limbs[i] = (sg_limb_t)(limb & SAFEGCD_MASK);
+    }
+}
+
+/* limbs must be normalized: non-negative, with all but the top limb below 2^SAFEGCD_BITS */
+static void safegcd_to_vli(uECC_word_t *vli,
+                           const sg_limb_t *limbs,
+                           wordcount_t num_words,
+                           int num_limbs) {
+    wordcount_t w;
+    for (w = 0; w < num_words; ++w) {
+        bitcount_t bit = w * uECC_WORD_BITS;
+        bitcount_t done = 0;
+        uECC_word_t word = 0;
+        while (done < uECC_WORD_BITS && bit / SAFEGCD_BITS < num_limbs) {
+            bitcount_t offset = bit % SAFEGCD_BITS;
+            word |= (uECC_word_t)((sg_ulimb_t)limbs[bit / SAFEGCD_BITS] >> offset) << done;
+            done += SAFEGCD_BITS - offset;
+            bit += SAFEGCD_BITS - offset;
+        }
+        vli[w] = word;
+    }
+}
+
+/* Runs SAFEGCD_BITS divsteps on the low bits of f and g, without branches. Returns the new
+   delta, and in t the matrix that maps (f, g) to 2^SAFEGCD_BITS times their new values. */
+static sg_limb_t safegcd_divsteps(sg_limb_t delta, sg_ulimb_t f, sg_ulimb_t g, sg_limb_t t[4]) {
+    sg_ulimb_t u = 1, v = 0, q = 0, r = 1;
+    sg_ulimb_t odd, swap, x;
+    int i;
+    for (i = 0; i < SAFEGCD_BITS; ++i) {
+        /* If delta > 0 and g is odd: delta = -delta, (f, g) = (g, -f) */
+        odd = -(g & 1);
+        swap = (sg_ulimb_t)SAFEGCD_SIGN(-delta) & odd;
+        delta = (delta ^ (sg_limb_t)swap) - (sg_limb_t)swap;
+        x = (f ^ g) & swap;
+        f ^= x;
+        g ^= x;
+        g = (g ^ swap) - swap;
+        x = (u ^ q) & swap;
+        u ^= x;
+        q ^= x;
+        q = (q ^ swap) - swap;
+        x = (v ^ r) & swap;
+        v ^= x;
+        r ^= x;
+        r = (r ^ swap) - swap;
+
+        /* Then delta += 1, g = (g + (g odd ? f : 0)) / 2 */
+        ++delta;
+        g += f & odd;
+        q += u & odd;
+        r += v & odd;
+        g >>= 1;
+        u <<= 1;
+        v <<= 1;
+    }
+    t[0] = (sg_limb_t)u;
+    t[1] = (sg_limb_t)v;
+    t[2] = (sg_limb_t)q;
+    t[3] = (sg_limb_t)r;
+    return delta;
+}
+
+/* (f, g) = t * (f, g) / 2^SAFEGCD_BITS; the division is exact. */
+static void safegcd_update_fg(sg_limb_t *f, sg_limb_t *g, const sg_limb_t t[4], int num_limbs) {
+    sg_wide_t cf = (sg_wide_t)t[0] * f[0] + (sg_wide_t)t[1] * g[0];
+    sg_wide_t cg = (sg_wide_t)t[2] * f[0] + (sg_wide_t)t[3] * g[0];
+    int i;
+    cf >>= SAFEGCD_BITS;
+    cg >>= SAFEGCD_BITS;
+    for (i = 1; i < num_limbs; ++i) {
+        cf += (sg_wide_t)t[0] * f[i] + (sg_wide_t)t[1] * g[i];
+        cg += (sg_wide_t)t[2] * f[i] + (sg_wide_t)t[3] * g[i];
+        f[i - 1] = (sg_limb_t)((sg_ulimb_t)cf & SAFEGCD_MASK);
+        g[i - 1] = (sg_limb_t)((sg_ulimb_t)cg & SAFEGCD_MASK);
+        cf >>= SAFEGCD_BITS;
+        cg >>= SAFEGCD_BITS;
+    }
+    f[num_limbs - 1] = (sg_limb_t)cf;
+    g[num_limbs - 1] = (sg_limb_t)cg;
+}
+
+/* (d, e) = t * (d, e) / 2^SAFEGCD_BITS (mod mod). Multiples of mod are added to make the
+   division exact and to keep d and e in (-2 * mod, mod); mod_inv = 1 / mod (mod 2^SAFEGCD_BITS). */
+static void safegcd_update_de(sg_limb_t *d,
+                              sg_limb_t *e,
+                              const sg_limb_t t[4],
+                              const sg_limb_t *mod,
+                              sg_ulimb_t mod_inv,
+                              int num_limbs) {
+    const sg_limb_t sd = SAFEGCD_SIGN(d[num_limbs - 1]);
+    const sg_limb_t se = SAFEGCD_SIGN(e[num_limbs - 1]);
+    sg_limb_t md = (t[0] & sd) + (t[1] & se);
+    sg_limb_t me = (t[2] & sd) + (t[3] & se);
+    sg_wide_t cd = (sg_wide_t)t[0] * d[0] + (sg_wide_t)t[1] * e[0];
+    sg_wide_t ce = (sg_wide_t)t[2] * d[0] + (sg_wide_t)t[3] * e[0];
+    int i;
+    md -= (sg_limb_t)((mod_inv * (sg_ulimb_t)cd + (sg_ulimb_t)md) & SAFEGCD_MASK);
+    me -= (sg_limb_t)((mod_inv * (sg_ulimb_t)ce + (sg_ulimb_t)me) & SAFEGCD_MASK);
+    cd += (sg_wide_t)mod[0] * md;
+    ce += (sg_wide_t)mod[0] * me;
+    cd >>= SAFEGCD_BITS;
+    ce >>= SAFEGCD_BITS;
+    for (i = 1; i < num_limbs; ++i) {
+        cd += (sg_wide_t)t[0] * d[i] + (sg_wide_t)t[1] * e[i] + (sg_wide_t)mod[i] * md;
+        ce += (sg_wide_t)t[2] * d[i] + (sg_wide_t)t[3] * e[i] + (sg_wide_t)mod[i] * me;
+        d[i - 1] = (sg_limb_t)((sg_ulimb_t)cd & SAFEGCD_MASK);
+        e[i - 1] = (sg_limb_t)((sg_ulimb_t)ce & SAFEGCD_MASK);
+        cd >>= SAFEGCD_BITS;
+        ce >>= SAFEGCD_BITS;
+    }
+    d[num_limbs - 1] = (sg_limb_t)cd;
+    e[num_limbs - 1] = (sg_limb_t)ce;
+}
+
+static void safegcd_carry(sg_limb_t *limbs, int num_limbs) {
+    int i;
+    for (i = 0; i < num_limbs - 1; ++i) {
+        limbs[i + 1] += limbs[i] >> SAFEGCD_BITS;
+        limbs[i] &= SAFEGCD_MASK;
+    }
+}
+
+/* Adds mod if the value is negative */
+static void safegcd_add_if_negative(sg_limb_t *limbs, const sg_limb_t *mod, int num_limbs) {
+    const sg_limb_t negative = SAFEGCD_SIGN(limbs[num_limbs - 1]);
+    int i;
+    for (i = 0; i < num_limbs; ++i) {
+        limbs[i] += mod[i] & negative;
+    }
+    safegcd_carry(limbs, num_limbs);
+}
+
+/* Computes result = (1 / input) % mod, for odd mod. Constant time; the number of rounds
+   only depends on the size of mod. */
+uECC_VLI_API void uECC_vli_modInv(uECC_word_t *result,
+                                  const uECC_word_t *input,
+                                  const uECC_word_t *mod,
+                                  wordcount_t num_words) {
+    sg_limb_t f[SAFEGCD_MAX_LIMBS], g[SAFEGCD_MAX_LIMBS];
+    sg_limb_t d[SAFEGCD_MAX_LIMBS], e[SAFEGCD_MAX_LIMBS];
+    sg_limb_t m[SAFEGCD_MAX_LIMBS], t[4];
+    sg_limb_t delta = 1, negate;
+    sg_ulimb_t mod_inv;
+    const bitcount_t num_bits = uECC_vli_numBits(mod, num_words);
+    const int num_limbs = num_bits / SAFEGCD_BITS + 1;
+    /* Divsteps needed for inputs below 2^num_bits (Theorem 11.2 of the paper) */
+    const int divsteps = ((num_bits < 46 ? 80 : 57) + 49 * num_bits + 16) / 17;
+    int i;
+
+    PHASE_BEGIN(phase);
+    safegcd_from_vli(m, mod, num_words, num_limbs);
+    safegcd_from_vli(g, input, num_words, num_limbs);
+    for (i = 0; i < num_limbs; ++i) {
+        f[i] = m[i];
+        d[i] = 0;
+        e[i] = 0;
+    }
+    e[0] = 1;
+
+    /* Newton iteration; an odd mod is its own inverse modulo 8 */
+    mod_inv = (sg_ulimb_t)m[0];
+    for (i = 0; i < 5; ++i) {
+        mod_inv *= 2 - (sg_ulimb_t)m[0] * mod_inv;
+    }
+
+    for (i = 0; i < divsteps; i += SAFEGCD_BITS) {
+        delta = safegcd_divsteps(delta, (sg_ulimb_t)f[0], (sg_ulimb_t)g[0], t);
+        safegcd_update_fg(f, g, t, num_limbs);
+        safegcd_update_de(d, e, t, m, mod_inv, num_limbs);
+    }
+
+    /* Now g = 0 and f = +-1, with d * input = f (mod mod) */
+    safegcd_carry(d, num_limbs);
+    safegcd_add_if_negative(d, m, num_limbs);
+    negate = SAFEGCD_SIGN(f[num_limbs - 1]);
+    for (i = 0; i < num_limbs; ++i) {
+        d[i] = (d[i] ^ negate) - negate;
+    }
+    safegcd_carry(d, num_limbs);
+    safegcd_add_if_negative(d, m, num_limbs);
+    safegcd_to_vli(result, d, num_words, num_limbs);
+    PHASE_END("uECC uECC_vli_modInv", phase);
+}
+
+#else /* !uECC_SAFEGCD_INVERSE */
+
 #define EVEN(vli) (!(vli[0] & 1))
 static void vli_modInv_update(uECC_word_t *uv,
                               const uECC_word_t *mod,
@@ -700,6 +1038,7 @@ uECC_VLI_API void uECC_vli_modInv(uECC_word_t *result,
         return;
     }
 
+    PHASE_BEGIN(phase);
     uECC_vli_set(a, input, num_words);
     uECC_vli_set(b, mod, num_words);
     uECC_vli_clear(u, num_words);
@@ -731,8 +1070,11 @@ uECC_VLI_API void uECC_vli_modInv(uECC_word_t *result,
         }
     }
     uECC_vli_set(result, u, num_words);
+    PHASE_END("uECC uECC_vli_modInv", phase);
 }
 
+#endif /* uECC_SAFEGCD_INVERSE */
+
 /* ------ Point operations ------ */
 
 #include "curve-specific.inc"
@@ -853,6 +1195,247 @@ static void XYcZ_addC(uECC_word_t * X1,
     uECC_vli_set(X1, t7, num_words);
 }
 
+#if uECC_FIXED_BASE_TABLES || (uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV)
+/* Sets dest = src if select is 1; leaves dest alone if select is 0. Constant-time. */
+static void vli_select(uECC_word_t *dest,
+                       const uECC_word_t *src,
+                       uECC_word_t select,
+                       wordcount_t num_words) {
+    uECC_word_t mask = (uECC_word_t)0 - select;
+    wordcount_t i;
+    for (i = 0; i < num_words; ++i) {
+        dest[i] ^= (dest[i] ^ src[i]) & mask;
+    }
+}
+
+/* Returns bits bit .. bit + 3 of vli; bits past the end read as 0. */
+static uECC_word_t vli_window4(const uECC_word_t *vli, bitcount_t bit, wordcount_t num_words) {
+    uECC_word_t window = 0;
+    bitcount_t i;
+    for (i = 3; i >= 0; --i) {
+        window <<= 1;
+        if (bit + i < (bitcount_t)num_words * uECC_WORD_BITS) {
+            window |= !!uECC_vli_testBit(vli, bit + i);
+        }
+    }
+    return window;
+}
+#endif /* uECC_FIXED_BASE_TABLES || (uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV) */
+
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV
+#define GLV_ENTRIES 8  /* P, 3P, ..., 15P */
+#define GLV_WINDOWS 33 /* 4-bit windows for split scalars of up to 2^128 */
+#define GLV_WIDTH 5    /* non-adjacent form whose digits index GLV_ENTRIES odd multiples */
+
+/* Fills table with the affine odd multiples P, 3P, ..., 15P of point, which must have prime
+   order, using a single inversion. The co-Z additions (2j + 1)P = (2j - 1)P + 2P leave every
+   entry on a different Z, each the previous one times x2 - x1 of the next addition, so those
+   ratios take the inverse of the last Z back to the earlier ones. */
+static void EccPoint_odd_multiples(uECC_word_t *table,
+                                   const uECC_word_t *point,
+                                   uECC_Curve curve) {
+    uECC_word_t twice_x[uECC_MAX_WORDS];
+    uECC_word_t twice_y[uECC_MAX_WORDS];
+    uECC_word_t ratios[GLV_ENTRIES][uECC_MAX_WORDS];
+    uECC_word_t z[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    unsigned j;
+
+    uECC_vli_set(table, point, num_words * 2);
+    uECC_vli_set(twice_x, point, num_words);
+    uECC_vli_set(twice_y, point + num_words, num_words);
+    uECC_vli_clear(z, num_words);
+    z[0] = 1;
+    curve->double_jacobian(twice_x, twice_y, z, curve);
+    apply_z(table, table + num_words, z, curve);
+
+    for (j = 1; j < GLV_ENTRIES; ++j) {
+        uECC_word_t *entry = table + j * 2 * num_words;
+        uECC_vli_set(entry, entry - 2 * num_words, num_words * 2);
+        uECC_vli_modSub(ratios[j], entry, twice_x, curve->p, num_words); /* x2 - x1 */
+        XYcZ_add(twice_x, twice_y, entry, entry + num_words, curve);
+        uECC_vli_modMult_fast(z, z, ratios[j], curve);
+    }
+
+    uECC_vli_modInv(z, z, curve->p, num_words);
+    for (j = GLV_ENTRIES - 1; ; --j) {
+        apply_z(table + j * 2 * num_words, table + j * 2 * num_words + num_words, z, curve);
+        if (j == 0) {
+            break;
+        }
+        uECC_vli_modMult_fast(z, z, ratios[j], curve);
+    }
+}
+
+/* Splits k < n into k1 + k2 * lambda (mod n) with |k1|, |k2| < 2^128, the decomposition of
+   Gallant, Lambert and Vanstone as done in libsecp256k1: c1 and c2 are k * b2 / n and
+   k * -b1 / n rounded, computed as (k * g) >> 384, and k2 = c1 * -b1 + c2 * -b2. Sets k1 and k2
+   to the absolute values, and negative[i] to 1 where ki is negative. Constant-time. */
+static void split_scalar_secp256k1(uECC_word_t *k1,
+                                   uECC_word_t *k2,
+                                   uECC_word_t *negative,
+                                   const uECC_word_t *k) {
+    uECC_Curve curve = &curve_secp256k1;
+    uECC_word_t product[2 * num_words_secp256k1];
+    uECC_word_t c1[num_words_secp256k1];
+    uECC_word_t c2[num_words_secp256k1];
+    uECC_word_t one[num_words_secp256k1];
+    uECC_word_t *halves[2] = {k1, k2};
+    unsigned i;
+
+    uECC_vli_clear(one, num_words_secp256k1);
+    one[0] = 1;
+    uECC_vli_mult(product, k, secp256k1_g1, num_words_secp256k1);
+    vli_rshift(c1, product, 383, 2 * num_words_secp256k1, num_words_secp256k1);
+    uECC_vli_add(c1, c1, one, num_words_secp256k1);
+    uECC_vli_rshift1(c1, num_words_secp256k1); /* c1 = round(product / 2^384) */
+    uECC_vli_mult(product, k, secp256k1_g2, num_words_secp256k1);
+    vli_rshift(c2, product, 383, 2 * num_words_secp256k1, num_words_secp256k1);
+    uECC_vli_add(c2, c2, one, num_words_secp256k1);
+    uECC_vli_rshift1(c2, num_words_secp256k1);
+
+    vli_modMult_n(c1, c1, secp256k1_minus_b1, curve);
+    vli_modMult_n(c2, c2, secp256k1_minus_b2, curve);
+    uECC_vli_modAdd(k2, c1, c2, curve->n, num_words_secp256k1);
+    vli_modMult_n(c1, k2, secp256k1_lambda, curve);
+    uECC_vli_modSub(k1, k, c1, curve->n, num_words_secp256k1);
+
+    /* A negative half is n - |ki| > n - 2^128, which has the top bit set. */
+    for (i = 0; i < 2; ++i) {
+        negative[i] = !!uECC_vli_testBit(halves[i], 255);
+        uECC_vli_sub(c1, curve->n, halves[i], num_words_secp256k1);
+        vli_select(halves[i], c1, negative[i], num_words_secp256k1);
+    }
+}
+
+/* Computes result = k * point on secp256k1 as k1 * point + k2 * (lambda * point), for the
+   split of k, with the regular signed 4-bit windows of EccPoint_mult_fixed_base_jacobian():
+   each of the GLV_WINDOWS windows takes four doublings and one addition from each of the tables
+   of odd multiples of point and lambda * point, picked by a scan of all entries. The windows
+   need odd scalars, so an even half is replaced by |ki| + 1 and point (or lambda * point)
+   subtracted at the end by a select. scalar is that of EccPoint_mult() for num_bits =
+   num_n_bits + 1, whose top bit is implicit, so k = scalar + 2^256 (mod n).
+
+   Returns 0 without touching result if some addition hit equal x coordinates, which needs a
+   negligible fraction of scalars; EccPoint_mult() then runs the ladder. Constant-time
+   otherwise. */
+static uECC_word_t EccPoint_mult_glv(uECC_word_t *result,
+                                     const uECC_word_t *point,
+                                     const uECC_word_t *scalar,
+                                     const uECC_word_t *initial_Z,
+                                     uECC_Curve curve) {
+    uECC_word_t table[GLV_ENTRIES * 2 * num_words_secp256k1];
+    uECC_word_t lambda_x[GLV_ENTRIES * num_words_secp256k1];
+    uECC_word_t k[2][2 * num_words_secp256k1];
+    uECC_word_t negative[2];
+    uECC_word_t skew[2];
+    uECC_word_t rx[num_words_secp256k1];
+    uECC_word_t ry[num_words_secp256k1];
+    uECC_word_t z[num_words_secp256k1];
+    uECC_word_t sx[num_words_secp256k1];
+    uECC_word_t sy[num_words_secp256k1];
+    uECC_word_t sz[num_words_secp256k1];
+    uECC_word_t tx[num_words_secp256k1];
+    uECC_word_t ty[num_words_secp256k1];
+    uECC_word_t tz[num_words_secp256k1];
+    uECC_word_t distinct = 1;
+    bitcount_t i;
+    unsigned s;
+    unsigned j;
+
+    /* k[0] = scalar + 2^256 as a double-width number, reduced by Barrett. */
+    uECC_vli_set(k[0], scalar, num_words_secp256k1);
+    uECC_vli_clear(k[0] + num_words_secp256k1, num_words_secp256k1);
+    k[0][num_words_secp256k1] = 1;
+    vli_mmod_n(tz, k[0], curve);
+    split_scalar_secp256k1(k[0], k[1], negative, tz);
+    for (s = 0; s < 2; ++s) {
+        skew[s] = !uECC_vli_testBit(k[s], 0);
+        uECC_vli_clear(tz, num_words_secp256k1);
+        tz[0] = skew[s];
+        uECC_vli_add(k[s], k[s], tz, num_words_secp256k1);
+    }
+
+    EccPoint_odd_multiples(table, point, curve);
+    for (j = 0; j < GLV_ENTRIES; ++j) {
+        uECC_vli_modMult_fast(lambda_x + j * num_words_secp256k1,
+                              table + j * 2 * num_words_secp256k1, secp256k1_beta, curve);
+    }
+
+    for (i = GLV_WINDOWS - 1; i >= 0; --i) {
+        if (i < GLV_WINDOWS - 1) {
+            for (j = 0; j < 4; ++j) {
+                curve->double_jacobian(rx, ry, z, curve);
+            }
+        }
+        for (s = 0; s < 2; ++s) {
+            uECC_word_t window = vli_window4(k[s], 4 * i + 1, num_words_secp256k1);
+            uECC_word_t digit_negative = (i < GLV_WINDOWS - 1) & !(window >> 3);
+            uECC_word_t index = (window & 7) ^ (digit_negative * 7);
+
+            uECC_vli_clear(tx, num_words_secp256k1);
+            uECC_vli_clear(ty, num_words_secp256k1);
+            for (j = 0; j < GLV_ENTRIES; ++j) {
+                const uECC_word_t *x = (s ? lambda_x + j * num_words_secp256k1 :
+                                            table + j * 2 * num_words_secp256k1);
+                vli_select(tx, x, j == index, num_words_secp256k1);
+                vli_select(ty, table + (2 * j + 1) * num_words_secp256k1, j == index,
+                           num_words_secp256k1);
+            }
+            uECC_vli_sub(tz, curve->p, ty, num_words_secp256k1);
+            vli_select(ty, tz, digit_negative ^ negative[s], num_words_secp256k1);
+
+            if (i == GLV_WINDOWS - 1 && s == 0) {
+                uECC_vli_set(rx, tx, num_words_secp256k1);
+                uECC_vli_set(ry, ty, num_words_secp256k1);
+                uECC_vli_clear(z, num_words_secp256k1);
+                z[0] = 1;
+                if (initial_Z) {
+                    uECC_vli_set(z, initial_Z, num_words_secp256k1);
+                    apply_z(rx, ry, z, curve);
+                }
+                continue;
+            }
+            apply_z(tx, ty, z, curve);
+            uECC_vli_modSub(tz, rx, tx, curve->p, num_words_secp256k1); /* Z = x2 - x1 */
+            distinct &= !uECC_vli_isZero(tz, num_words_secp256k1);
+            XYcZ_add(tx, ty, rx, ry, curve);
+            uECC_vli_modMult_fast(z, z, tz, curve);
+        }
+    }
+
+    /* Undo the skews: subtract (the signed) point or lambda * point, on a copy. */
+    for (s = 0; s < 2; ++s) {
+        uECC_vli_set(tx, s ? lambda_x : table, num_words_secp256k1);
+        uECC_vli_set(ty, table + num_words_secp256k1, num_words_secp256k1);
+        uECC_vli_sub(tz, curve->p, ty, num_words_secp256k1);
+        vli_select(ty, tz, !negative[s], num_words_secp256k1);
+        uECC_vli_set(sx, rx, num_words_secp256k1);
+        uECC_vli_set(sy, ry, num_words_secp256k1);
+        uECC_vli_set(sz, z, num_words_secp256k1);
+
+        apply_z(tx, ty, sz, curve);
+        uECC_vli_modSub(tz, sx, tx, curve->p, num_words_secp256k1); /* Z = x2 - x1 */
+        distinct &= !(skew[s] & uECC_vli_isZero(tz, num_words_secp256k1));
+        XYcZ_add(tx, ty, sx, sy, curve);
+        uECC_vli_modMult_fast(sz, sz, tz, curve);
+
+        vli_select(rx, sx, skew[s], num_words_secp256k1);
+        vli_select(ry, sy, skew[s], num_words_secp256k1);
+        vli_select(z, sz, skew[s], num_words_secp256k1);
+    }
+
+    if (!distinct) {
+        return 0;
+    }
+    uECC_vli_modInv(z, z, curve->p, num_words_secp256k1); /* Z = 1/Z */
+    apply_z(rx, ry, z, curve);
+    uECC_vli_set(result, rx, num_words_secp256k1);
+    uECC_vli_set(result + num_words_secp256k1, ry, num_words_secp256k1);
+    return 1;
+}
+#endif /* uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV */
+
 /* result may overlap point. */
 static void EccPoint_mult(uECC_word_t * result,
                           const uECC_word_t * point,
@@ -867,6 +1450,15 @@ static void EccPoint_mult(uECC_word_t * result,
     bitcount_t i;
     uECC_word_t nb;
     wordcount_t num_words = curve->num_words;
+    PHASE_BEGIN(phase);
+
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV
+    if (curve == &curve_secp256k1 && num_bits == curve->num_n_bits + 1 &&
+            EccPoint_mult_glv(result, point, scalar, initial_Z, curve)) {
+        PHASE_END("uECC EccPoint_mult", phase);
+        return;
+    }
+#endif
 
     uECC_vli_set(Rx[1], point, num_words);
     uECC_vli_set(Ry[1], point + num_words, num_words);
@@ -897,6 +1489,7 @@ static void EccPoint_mult(uECC_word_t * result,
 
     uECC_vli_set(result, Rx[0], num_words);
     uECC_vli_set(result + num_words, Ry[0], num_words);
+    PHASE_END("uECC EccPoint_mult", phase);
 }
 
 static uECC_word_t regularize_k(const uECC_word_t * const k,
@@ -912,19 +1505,121 @@ static uECC_word_t regularize_k(const uECC_word_t * const k,
     return carry;
 }
 
-static uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
-                                               uECC_word_t *private_key,
-                                               uECC_Curve curve) {
+#if uECC_FIXED_BASE_TABLES
+#define FIXED_BASE_ENTRIES 8 /* 1, 3, ..., 15 times the window's power of 16 */
+
+/* Computes result = scalar * G for 0 < scalar < n using curve->G_table, which holds
+   (2j + 1) * 16^i * G for every 4-bit window i (see scripts/fixed_base.py).
+
+   An odd scalar k has the regular signed-window form k = sum(d_i * 16^i) with every d_i odd
+   and in [-15, 15]: d_i = 2 * (bits 4i+1 .. 4i+4 of k) + 1 - 16, except for the top window,
+   which takes the remaining bits unsigned. So each window adds exactly one table point,
+   picked by a scan of all its entries and negated by a select, and no doublings are needed.
+   An even scalar is replaced by n - scalar, which is odd, and the result negated.
+
+   The result is left in Jacobian coordinates (rx, ry, z), so that uECC_make_keys_batch() can
+   share the inversion of z between keys.
+
+   Returns 0 if some addition hit equal x coordinates, which the co-Z formulas do not handle;
+   that needs the partial sum to equal a table point up to sign, which happens for a
+   negligible fraction of scalars. The caller falls back to EccPoint_mult() then. */
+static uECC_word_t EccPoint_mult_fixed_base_jacobian(uECC_word_t *rx,
+                                                     uECC_word_t *ry,
+                                                     uECC_word_t *z,
+                                                     const uECC_word_t *scalar,
+                                                     uECC_Curve curve) {
+    uECC_word_t k[uECC_MAX_WORDS];
+    uECC_word_t tx[uECC_MAX_WORDS];
+    uECC_word_t ty[uECC_MAX_WORDS];
+    uECC_word_t tz[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    bitcount_t windows = (curve->num_n_bits + 3) / 4;
+    uECC_word_t even = !uECC_vli_testBit(scalar, 0);
+    uECC_word_t distinct = 1;
+    bitcount_t i;
+    PHASE_BEGIN(phase);
+
+    uECC_vli_set(k, scalar, num_n_words);
+    uECC_vli_sub(tz, curve->n, scalar, num_n_words);
+    vli_select(k, tz, even, num_n_words);
+    uECC_vli_clear(z, num_words);
+    z[0] = 1;
+
+    for (i = 0; i < windows; ++i) {
+        const uECC_word_t *table = curve->G_table + i * FIXED_BASE_ENTRIES * 2 * num_words;
+        uECC_word_t window = vli_window4(k, 4 * i + 1, num_n_words);
+        uECC_word_t negative = (i < windows - 1) & !(window >> 3);
+        uECC_word_t index = (window & 7) ^ (negative * 7);
+        uECC_word_t j;
+
+        uECC_vli_clear(tx, num_words);
+        uECC_vli_clear(ty, num_words);
+        for (j = 0; j < FIXED_BASE_ENTRIES; ++j) {
+            vli_select(tx, table + j * 2 * num_words, j == index, num_words);
+            vli_select(ty, table + j * 2 * num_words + num_words, j == index, num_words);
+        }
+        uECC_vli_sub(tz, curve->p, ty, num_words);
+        vli_select(ty, tz, negative, num_words);
+
+        if (i == 0) {
+            uECC_vli_set(rx, tx, num_words);
+            uECC_vli_set(ry, ty, num_words);
+            continue;
+        }
+        apply_z(tx, ty, z, curve);
+        uECC_vli_modSub(tz, rx, tx, curve->p, num_words); /* Z = x2 - x1 */
+        distinct &= !uECC_vli_isZero(tz, num_words);
+        XYcZ_add(tx, ty, rx, ry, curve);
+        uECC_vli_modMult_fast(z, z, tz, curve);
+    }
+
+    uECC_vli_sub(tz, curve->p, ry, num_words);
+    vli_select(ry, tz, even, num_words);
+    PHASE_END("uECC EccPoint_mult_fixed_base", phase);
+    return distinct;
+}
+
+/* Computes result = scalar * G in affine coordinates; see EccPoint_mult_fixed_base_jacobian(). */
+static uECC_word_t EccPoint_mult_fixed_base(uECC_word_t *result,
+                                            const uECC_word_t *scalar,
+                                            uECC_Curve curve) {
+    uECC_word_t z[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+
+    if (!EccPoint_mult_fixed_base_jacobian(result, result + num_words, z, scalar, curve)) {
+        return 0;
+    }
+    uECC_vli_modInv(z, z, curve->p, num_words); /* Z = 1/Z */
+    apply_z(result, result + num_words, z, curve);
+    return 1;
+}
+#endif /* uECC_FIXED_BASE_TABLES */
+
+/* Computes result = scalar * G for 0 < scalar < n. */
+static void EccPoint_mult_G(uECC_word_t *result, const uECC_word_t *scalar, uECC_Curve curve) {
     uECC_word_t tmp1[uECC_MAX_WORDS];
     uECC_word_t tmp2[uECC_MAX_WORDS];
     uECC_word_t *p2[2] = {tmp1, tmp2};
     uECC_word_t carry;
 
-    /* Regularize the bitcount for the private key so that attackers cannot use a side channel
+#if uECC_FIXED_BASE_TABLES
+    if (EccPoint_mult_fixed_base(result, scalar, curve)) {
+        return;
+    }
+#endif
+
+    /* Regularize the bitcount for the scalar so that attackers cannot use a side channel
        attack to learn the number of leading zeros. */
-    carry = regularize_k(private_key, tmp1, tmp2, curve);
+    carry = regularize_k(scalar, tmp1, tmp2, curve);
 
     EccPoint_mult(result, curve->G, p2[!carry], 0, curve->num_n_bits + 1, curve);
+}
+
+static uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
+                                               uECC_word_t *private_key,
+                                               uECC_Curve curve) {
+    EccPoint_mult_G(result, private_key, curve);
 
     if (EccPoint_isZero(result, curve)) {
         return 0;
@@ -932,6 +1627,44 @@ static uECC_word_t EccPoint_compute_public_key(uECC_word_t *result,
     return 1;
 }
 
+/* Replaces each of the count values with its inverse modulo mod (curve->p or curve->n) using
+   a single inversion (Montgomery's trick): with prefix products P_i = v_0 * ... * v_i,
+   1/v_i = P_(i-1) / P_i, and 1/P_(i-1) = v_i / P_i. Costs 3 * (count - 1) multiplications,
+   by uECC_vli_modMult_fast() or vli_modMult_n().
+   None of the values may be 0. */
+static void vli_modInv_batch(uECC_word_t values[][uECC_MAX_WORDS],
+                             unsigned count,
+                             const uECC_word_t *mod,
+                             wordcount_t num_words,
+                             uECC_Curve curve) {
+    uECC_word_t prefix[uECC_BATCH_SIZE][uECC_MAX_WORDS];
+    uECC_word_t inverse[uECC_MAX_WORDS];
+    uECC_word_t t[uECC_MAX_WORDS];
+    unsigned i;
+
+    uECC_vli_set(prefix[0], values[0], num_words);
+    for (i = 1; i < count; ++i) {
+        if (mod == curve->p) {
+            uECC_vli_modMult_fast(prefix[i], prefix[i - 1], values[i], curve);
+        } else {
+            vli_modMult_n(prefix[i], prefix[i - 1], values[i], curve);
+        }
+    }
+
+    uECC_vli_modInv(inverse, prefix[count - 1], mod, num_words);
+    for (i = count - 1; i > 0; --i) {
+        if (mod == curve->p) {
+            uECC_vli_modMult_fast(t, inverse, prefix[i - 1], curve);
+            uECC_vli_modMult_fast(inverse, inverse, values[i], curve);
+        } else {
+            vli_modMult_n(t, inverse, prefix[i - 1], curve);
+            vli_modMult_n(inverse, inverse, values[i], curve);
+        }
+        uECC_vli_set(values[i], t, num_words);
+    }
+    uECC_vli_set(values[0], inverse, num_words);
+}
+
 #if uECC_WORD_SIZE == 1
 
 uECC_VLI_API void uECC_vli_nativeToBytes(uint8_t *bytes,
@@ -1031,6 +1764,110 @@ int uECC_make_key(uint8_t *public_key,
     return 0;
 }
 
+int uECC_make_keys_batch(unsigned count,
+                         uint8_t *public_keys,
+                         uint8_t *private_keys,
+                         uECC_Curve curve) {
+    uECC_word_t _private[uECC_MAX_WORDS];
+    uECC_word_t _public[uECC_MAX_WORDS * 2];
+    uECC_word_t rx[uECC_BATCH_SIZE][uECC_MAX_WORDS];
+    uECC_word_t ry[uECC_BATCH_SIZE][uECC_MAX_WORDS];
+    uECC_word_t z[uECC_BATCH_SIZE][uECC_MAX_WORDS];
+    unsigned indices[uECC_BATCH_SIZE];
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    /* Keys are word arrays here, laid out as uECC_make_key() leaves them. */
+    unsigned private_size = num_n_words * uECC_WORD_SIZE;
+    unsigned coordinate_size = num_words * uECC_WORD_SIZE;
+#else
+    unsigned private_size = BITS_TO_BYTES(curve->num_n_bits);
+    unsigned coordinate_size = curve->num_bytes;
+#endif
+    uECC_word_t mask =
+        (uECC_word_t)-1 >> ((bitcount_t)(num_n_words * uECC_WORD_BITS - curve->num_n_bits));
+    unsigned start;
+
+    if (!g_rng_function) {
+        return 0;
+    }
+    if (count == 0) {
+        return 1;
+    }
+
+    /* Draw every private key in one request. Draws that are 0 or not below n after masking are
+       replaced one at a time, as uECC_generate_random_int() would. */
+    if (!g_rng_function(private_keys, count * private_size)) {
+        return 0;
+    }
+
+    for (start = 0; start < count; start += uECC_BATCH_SIZE) {
+        unsigned end = (count - start < uECC_BATCH_SIZE ? count : start + uECC_BATCH_SIZE);
+        unsigned batch = 0;
+        unsigned i;
+
+        for (i = start; i < end; ++i) {
+            uint8_t *private_key = private_keys + i * private_size;
+            uint8_t *public_key = public_keys + i * 2 * coordinate_size;
+
+            _private[num_n_words - 1] = 0;
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+            bcopy((uint8_t *) _private, private_key, private_size);
+#else
+            uECC_vli_bytesToNative(_private, private_key, private_size);
+#endif
+            _private[num_n_words - 1] &= mask;
+            if (uECC_vli_isZero(_private, num_n_words) ||
+                    uECC_vli_cmp(curve->n, _private, num_n_words) != 1) {
+                if (!uECC_generate_random_int(_private, curve->n, num_n_words)) {
+                    return 0;
+                }
+            }
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+            bcopy(private_key, (uint8_t *) _private, private_size);
+#else
+            uECC_vli_nativeToBytes(private_key, private_size, _private);
+#endif
+
+#if uECC_FIXED_BASE_TABLES
+            if (EccPoint_mult_fixed_base_jacobian(rx[batch], ry[batch], z[batch], _private,
+                                                  curve)) {
+                indices[batch++] = i;
+                continue;
+            }
+#endif
+            /* No table, or a co-Z corner case: this key takes its own inversion. */
+            EccPoint_mult_G(_public, _private, curve);
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+            bcopy(public_key, (uint8_t *) _public, coordinate_size * 2);
+#else
+            uECC_vli_nativeToBytes(public_key, coordinate_size, _public);
+            uECC_vli_nativeToBytes(public_key + coordinate_size, coordinate_size,
+                                   _public + num_words);
+#endif
+        }
+        if (batch == 0) {
+            continue;
+        }
+
+        /* z = 1/z for the whole batch at the cost of one inversion. */
+        vli_modInv_batch(z, batch, curve->p, num_words, curve);
+
+        for (i = 0; i < batch; ++i) {
+            uint8_t *public_key = public_keys + indices[i] * 2 * coordinate_size;
+            apply_z(rx[i], ry[i], z[i], curve);
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+            bcopy(public_key, (uint8_t *) rx[i], coordinate_size);
+            bcopy(public_key + coordinate_size, (uint8_t *) ry[i], coordinate_size);
+#else
+            uECC_vli_nativeToBytes(public_key, coordinate_size, rx[i]);
+            uECC_vli_nativeToBytes(public_key + coordinate_size, coordinate_size, ry[i]);
+#endif
+        }
+    }
+    return 1;
+}
+
 int uECC_shared_secret(const uint8_t *public_key,
                        const uint8_t *private_key,
                        uint8_t *secret,
@@ -1238,24 +2075,20 @@ static int uECC_sign_with_k(const uint8_t *private_key,
 
     uECC_word_t tmp[uECC_MAX_WORDS];
     uECC_word_t s[uECC_MAX_WORDS];
-    uECC_word_t *k2[2] = {tmp, s};
 #if uECC_VLI_NATIVE_LITTLE_ENDIAN
     uECC_word_t *p = (uECC_word_t *)signature;
 #else
     uECC_word_t p[uECC_MAX_WORDS * 2];
 #endif
-    uECC_word_t carry;
     wordcount_t num_words = curve->num_words;
     wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
-    bitcount_t num_n_bits = curve->num_n_bits;
 
     /* Make sure 0 < k < curve_n */
     if (uECC_vli_isZero(k, num_words) || uECC_vli_cmp(curve->n, k, num_n_words) != 1) {
         return 0;
     }
 
-    carry = regularize_k(k, tmp, s, curve);
-    EccPoint_mult(p, curve->G, k2[!carry], 0, num_n_bits + 1, curve);
+    EccPoint_mult_G(p, k, curve);
     if (uECC_vli_isZero(p, num_words)) {
         return 0;
     }
@@ -1271,9 +2104,9 @@ static int uECC_sign_with_k(const uint8_t *private_key,
 
     /* Prevent side channel analysis of uECC_vli_modInv() to determine
        bits of k / the private key by premultiplying by a random number */
-    uECC_vli_modMult(k, k, tmp, curve->n, num_n_words); /* k' = rand * k */
+    vli_modMult_n(k, k, tmp, curve); /* k' = rand * k */
     uECC_vli_modInv(k, k, curve->n, num_n_words);       /* k = 1 / k' */
-    uECC_vli_modMult(k, k, tmp, curve->n, num_n_words); /* k = 1 / k */
+    vli_modMult_n(k, k, tmp, curve); /* k = 1 / k */
 
 #if uECC_VLI_NATIVE_LITTLE_ENDIAN == 0
     uECC_vli_nativeToBytes(signature, curve->num_bytes, p); /* store r */
@@ -1287,11 +2120,11 @@ static int uECC_sign_with_k(const uint8_t *private_key,
 
     s[num_n_words - 1] = 0;
     uECC_vli_set(s, p, num_words);
-    uECC_vli_modMult(s, tmp, s, curve->n, num_n_words); /* s = r*d */
+    vli_modMult_n(s, tmp, s, curve); /* s = r*d */
 
     bits2int(tmp, message_hash, hash_size, curve);
     uECC_vli_modAdd(s, tmp, s, curve->n, num_n_words); /* s = e + r*d */
-    uECC_vli_modMult(s, s, k, curve->n, num_n_words);  /* s = (e + r*d) / k */
+    vli_modMult_n(s, s, k, curve);  /* s = (e + r*d) / k */
     if (uECC_vli_numBits(s, num_n_words) > (bitcount_t)curve->num_bytes * 8) {
         return 0;
     }
@@ -1325,40 +2158,82 @@ int uECC_sign(const uint8_t *private_key,
 
 /* Compute an HMAC using K as a key (as in RFC 6979). Note that K is always
    the same size as the hash result size. */
-static void HMAC_init(const uECC_HashContext *hash_context, const uint8_t *K) {
+/* Fills the HMAC pad area of hash_context->tmp with K ^ byte, padded with byte to a block. */
+static void HMAC_pad(const uECC_HashContext *hash_context, const uint8_t *K, uint8_t byte) {
     uint8_t *pad = hash_context->tmp + 2 * hash_context->result_size;
     unsigned i;
     for (i = 0; i < hash_context->result_size; ++i)
-        pad[i] = K[i] ^ 0x36;
+        pad[i] = K[i] ^ byte;
     for (; i < hash_context->block_size; ++i)
-        pad[i] = 0x36;
+        pad[i] = byte;
+}
 
-    hash_context->init_hash(hash_context);
-    hash_context->update_hash(hash_context, pad, hash_context->block_size);
+/* Returns 1 if hash_context can save and restore hash states (both callbacks are set). */
+static int HMAC_can_cache(const uECC_HashContext *hash_context) {
+    return hash_context->save_state && hash_context->restore_state;
+}
+
+/* Called whenever K changes. If hash_context can save hash states, hashes the inner and
+   outer key pads of K once here, into states 0 and 1, so that HMAC_init() and HMAC_finish()
+   only restore them. */
+static void HMAC_set_key(const uECC_HashContext *hash_context, const uint8_t *K) {
+    uint8_t *pad = hash_context->tmp + 2 * hash_context->result_size;
+    PHASE_BEGIN(phase);
+    if (HMAC_can_cache(hash_context)) {
+        HMAC_pad(hash_context, K, 0x36);
+        hash_context->init_hash(hash_context);
+        hash_context->update_hash(hash_context, pad, hash_context->block_size);
+        hash_context->save_state(hash_context, 0);
+
+        HMAC_pad(hash_context, K, 0x5c);
+        hash_context->init_hash(hash_context);
+        hash_context->update_hash(hash_context, pad, hash_context->block_size);
+        hash_context->save_state(hash_context, 1);
+    }
+    PHASE_END("uECC HMAC", phase);
+}
+
+static void HMAC_init(const uECC_HashContext *hash_context, const uint8_t *K) {
+    uint8_t *pad = hash_context->tmp + 2 * hash_context->result_size;
+    PHASE_BEGIN(phase);
+    if (HMAC_can_cache(hash_context)) {
+        hash_context->restore_state(hash_context, 0);
+    } else {
+        HMAC_pad(hash_context, K, 0x36);
+        hash_context->init_hash(hash_context);
+        hash_context->update_hash(hash_context, pad, hash_context->block_size);
+    }
+    PHASE_END("uECC HMAC", phase);
 }
 
 static void HMAC_update(const uECC_HashContext *hash_context,
                         const uint8_t *message,
                         unsigned message_size) {
+    PHASE_BEGIN(phase);
     hash_context->update_hash(hash_context, message, message_size);
+    PHASE_END("uECC HMAC", phase);
 }
 
 static void HMAC_finish(const uECC_HashContext *hash_context,
                         const uint8_t *K,
                         uint8_t *result) {
     uint8_t *pad = hash_context->tmp + 2 * hash_context->result_size;
-    unsigned i;
-    for (i = 0; i < hash_context->result_size; ++i)
-        pad[i] = K[i] ^ 0x5c;
-    for (; i < hash_context->block_size; ++i)
-        pad[i] = 0x5c;
+    PHASE_BEGIN(phase);
+    if (!HMAC_can_cache(hash_context)) {
+        HMAC_pad(hash_context, K, 0x5c); /* before result, which may be K, is written */
+    }
 
     hash_context->finish_hash(hash_context, result);
 
-    hash_context->init_hash(hash_context);
-    hash_context->update_hash(hash_context, pad, hash_context->block_size);
+    if (HMAC_can_cache(hash_context)) {
+        hash_context->restore_state(hash_context, 1);
+    } else {
+        hash_context->init_hash(hash_context);
+        hash_context->update_hash(hash_context, pad, hash_context->block_size);
+    }
     hash_context->update_hash(hash_context, result, hash_context->result_size);
     hash_context->finish_hash(hash_context, result);
+    PHASE_END("uECC HMAC", phase);
 }
 
 /* V = HMAC_K(V) */
@@ -1391,6 +2266,7 @@ int uECC_sign_deterministic(const uint8_t *private_key,
         V[i] = 0x01;
         K[i] = 0;
     }
+    HMAC_set_key(hash_context, K);
 
     /* K = HMAC_K(V || 0x00 || int2octets(x) || h(m)) */
     HMAC_init(hash_context, K);
@@ -1399,6 +2275,7 @@ int uECC_sign_deterministic(const uint8_t *private_key,
     HMAC_update(hash_context, private_key, num_bytes);
     HMAC_update(hash_context, message_hash, hash_size);
     HMAC_finish(hash_context, K, K);
+    HMAC_set_key(hash_context, K);
 
     update_V(hash_context, K, V);
 
@@ -1409,6 +2286,7 @@ int uECC_sign_deterministic(const uint8_t *private_key,
     HMAC_update(hash_context, private_key, num_bytes);
     HMAC_update(hash_context, message_hash, hash_size);
     HMAC_finish(hash_context, K, K);
+    HMAC_set_key(hash_context, K);
 
     update_V(hash_context, K, V);
 
@@ -1441,6 +2319,7 @@ int uECC_sign_deterministic(const uint8_t *private_key,
         V[hash_context->result_size] = 0x00;
         HMAC_update(hash_context, V, hash_context->result_size + 1);
         HMAC_finish(hash_context, K, K);
+        HMAC_set_key(hash_context, K);
 
         update_V(hash_context, K, V);
     }
@@ -1451,6 +2330,67 @@ static bitcount_t smax(bitcount_t a, bitcount_t b) {
     return (a > b ? a : b);
 }
 
+/* Decodes the signature into r and s. Returns 0 if r or s is out of range. */
+static int decode_signature(uECC_word_t *r,
+                            uECC_word_t *s,
+                            const uint8_t *signature,
+                            uECC_Curve curve) {
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+
+    r[num_n_words - 1] = 0;
+    s[num_n_words - 1] = 0;
+
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    bcopy((uint8_t *) r, signature, curve->num_bytes);
+    bcopy((uint8_t *) s, signature + curve->num_bytes, curve->num_bytes);
+#else
+    uECC_vli_bytesToNative(r, signature, curve->num_bytes);
+    uECC_vli_bytesToNative(s, signature + curve->num_bytes, curve->num_bytes);
+#endif
+
+    /* r, s must not be 0. */
+    if (uECC_vli_isZero(r, num_words) || uECC_vli_isZero(s, num_words)) {
+        return 0;
+    }
+
+    /* r, s must be < n. */
+    if (uECC_vli_cmp_unsafe(curve->n, r, num_n_words) != 1 ||
+            uECC_vli_cmp_unsafe(curve->n, s, num_n_words) != 1) {
+        return 0;
+    }
+    return 1;
+}
+
+/* Calculates u1 = e/s and u2 = r/s (mod n), given s_inv = 1/s. */
+static void verify_scalars(uECC_word_t *u1,
+                           uECC_word_t *u2,
+                           const uECC_word_t *r,
+                           const uECC_word_t *s_inv,
+                           const uint8_t *message_hash,
+                           unsigned hash_size,
+                           uECC_Curve curve) {
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+
+    u1[num_n_words - 1] = 0;
+    bits2int(u1, message_hash, hash_size, curve);
+    vli_modMult_n(u1, u1, s_inv, curve); /* u1 = e/s */
+    vli_modMult_n(u2, r, s_inv, curve); /* u2 = r/s */
+}
+
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV
+static uECC_word_t mult_glv(uECC_word_t *rx,
+                            uECC_word_t *z,
+                            const uECC_word_t *u1,
+                            const uECC_word_t *u2,
+                            const uECC_word_t *point,
+                            uECC_Curve curve);
+static int x_equals_r(const uECC_word_t *X,
+                      const uECC_word_t *Z,
+                      const uECC_word_t *r,
+                      uECC_Curve curve);
+#endif
+
 int uECC_verify(const uint8_t *public_key,
                 const uint8_t *message_hash,
                 unsigned hash_size,
@@ -1478,37 +2418,26 @@ int uECC_verify(const uint8_t *public_key,
     wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
 
     rx[num_n_words - 1] = 0;
-    r[num_n_words - 1] = 0;
-    s[num_n_words - 1] = 0;
 
-#if uECC_VLI_NATIVE_LITTLE_ENDIAN
-    bcopy((uint8_t *) r, signature, curve->num_bytes);
-    bcopy((uint8_t *) s, signature + curve->num_bytes, curve->num_bytes);
-#else
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN == 0
     uECC_vli_bytesToNative(_public, public_key, curve->num_bytes);
     uECC_vli_bytesToNative(
         _public + num_words, public_key + curve->num_bytes, curve->num_bytes);
-    uECC_vli_bytesToNative(r, signature, curve->num_bytes);
-    uECC_vli_bytesToNative(s, signature + curve->num_bytes, curve->num_bytes);
 #endif
 
-    /* r, s must not be 0. */
-    if (uECC_vli_isZero(r, num_words) || uECC_vli_isZero(s, num_words)) {
-        return 0;
-    }
-
-    /* r, s must be < n. */
-    if (uECC_vli_cmp_unsafe(curve->n, r, num_n_words) != 1 ||
-            uECC_vli_cmp_unsafe(curve->n, s, num_n_words) != 1) {
+    if (!decode_signature(r, s, signature, curve)) {
         return 0;
     }
 
     /* Calculate u1 and u2. */
     uECC_vli_modInv(z, s, curve->n, num_n_words); /* z = 1/s */
-    u1[num_n_words - 1] = 0;
-    bits2int(u1, message_hash, hash_size, curve);
-    uECC_vli_modMult(u1, u1, z, curve->n, num_n_words); /* u1 = e/s */
-    uECC_vli_modMult(u2, r, z, curve->n, num_n_words); /* u2 = r/s */
+    verify_scalars(u1, u2, r, z, message_hash, hash_size, curve);
+
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV
+    if (curve == &curve_secp256k1) {
+        return mult_glv(rx, z, u1, u2, _public, curve) && x_equals_r(rx, z, r, curve);
+    }
+#endif
 
     /* Calculate sum = G + Q. */
     uECC_vli_set(sum, _public, num_words);
@@ -1563,6 +2492,463 @@ int uECC_verify(const uint8_t *public_key,
     return (int)(uECC_vli_equal(rx, r, num_words));
 }
 
+/* Width of the non-adjacent forms used by uECC_verify_prepared(). The digits of a width-w form
+   are odd multiples of at most 2^(w-1) - 1, so the Q digits index the uECC_PREPARED_POINTS
+   odd multiples of a prepared key, and the G digits the first window of curve->G_table,
+   which holds G, 3G, ..., 15G. Without that table only G itself is at hand. */
+#define PREPARED_Q_WIDTH 6
+#if uECC_FIXED_BASE_TABLES
+    #define PREPARED_G_WIDTH 5
+#else
+    #define PREPARED_G_WIDTH 2
+#endif
+
+#if uECC_WORD_SIZE == 1
+    #define prepared_points(key) ((key)->points.u8)
+#elif uECC_WORD_SIZE == 4
+    #define prepared_points(key) ((key)->points.u32)
+#else
+    #define prepared_points(key) ((key)->points.u64)
+#endif
+
+/* Writes the width-w non-adjacent form of scalar to naf, least significant digit first, as
+   num_n_bits + 1 digits. Every nonzero digit is odd and is followed by at least w - 1 zeros,
+   so a w-bit window costs one addition on average instead of one per set bit. */
+static void vli_wnaf(int8_t *naf, const uECC_word_t *scalar, unsigned width, uECC_Curve curve) {
+    uECC_word_t k[uECC_MAX_WORDS + 1];
+    uECC_word_t d[uECC_MAX_WORDS];
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    bitcount_t i;
+
+    /* k needs a word above n for carries; the asm add and sub only go up to uECC_MAX_WORDS,
+       so that word is updated by hand. */
+    uECC_vli_set(k, scalar, num_n_words);
+    k[num_n_words] = 0;
+    uECC_vli_clear(d, num_n_words);
+    for (i = 0; i <= curve->num_n_bits; ++i) {
+        int digit = 0;
+        if (k[0] & 1) {
+            digit = (int)(k[0] & ((1u << width) - 1));
+            if (digit >= (1 << (width - 1))) {
+                digit -= (1 << width);
+                d[0] = (uECC_word_t)-digit;
+                k[num_n_words] += uECC_vli_add(k, k, d, num_n_words);
+            } else {
+                d[0] = (uECC_word_t)digit;
+                k[num_n_words] -= uECC_vli_sub(k, k, d, num_n_words);
+            }
+        }
+        naf[i] = (int8_t)digit;
+        uECC_vli_rshift1(k, num_n_words + 1);
+    }
+}
+
+/* Adds (x, y) * sign(digit) to the Jacobian point (rx, ry, z), where the affine (x, y) is the
+   |digit|th odd multiple in table; *infinity marks (rx, ry, z) as the point at infinity.
+   Unlike the loop in uECC_verify() this handles equal x coordinates, but it is variable-time,
+   which is fine for verification. */
+static void add_table_point(uECC_word_t *rx,
+                            uECC_word_t *ry,
+                            uECC_word_t *z,
+                            uECC_word_t *infinity,
+                            const uECC_word_t *table,
+                            int digit,
+                            uECC_Curve curve) {
+    uECC_word_t tx[uECC_MAX_WORDS];
+    uECC_word_t ty[uECC_MAX_WORDS];
+    uECC_word_t tz[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    const uECC_word_t *point = table + ((digit < 0 ? -digit : digit) >> 1) * 2 * num_words;
+
+    uECC_vli_set(tx, point, num_words);
+    if (digit < 0) {
+        uECC_vli_sub(ty, curve->p, point + num_words, num_words);
+    } else {
+        uECC_vli_set(ty, point + num_words, num_words);
+    }
+    if (*infinity) {
+        uECC_vli_set(rx, tx, num_words);
+        uECC_vli_set(ry, ty, num_words);
+        uECC_vli_clear(z, num_words);
+        z[0] = 1;
+        *infinity = 0;
+        return;
+    }
+
+    apply_z(tx, ty, z, curve);
+    uECC_vli_modSub(tz, rx, tx, curve->p, num_words); /* Z = x2 - x1 */
+    if (uECC_vli_isZero(tz, num_words)) {
+        if (uECC_vli_equal(ry, ty, num_words)) {
+            curve->double_jacobian(rx, ry, z, curve);
+        } else {
+            *infinity = 1;
+        }
+        return;
+    }
+    XYcZ_add(tx, ty, rx, ry, curve);
+    uECC_vli_modMult_fast(z, z, tz, curve);
+}
+
+int uECC_prepare_public_key(const uint8_t *public_key,
+                            uECC_PreparedKey *prepared,
+                            uECC_Curve curve) {
+    uECC_word_t *points = prepared_points(prepared);
+    uECC_word_t twice_x[uECC_MAX_WORDS];
+    uECC_word_t twice_y[uECC_MAX_WORDS];
+    uECC_word_t tx[uECC_MAX_WORDS];
+    uECC_word_t ty[uECC_MAX_WORDS];
+    uECC_word_t z[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    unsigned j;
+
+#if uECC_VLI_NATIVE_LITTLE_ENDIAN
+    uECC_vli_set(points, (const uECC_word_t *)public_key, num_words * 2);
+#else
+    uECC_vli_bytesToNative(points, public_key, curve->num_bytes);
+    uECC_vli_bytesToNative(points + num_words, public_key + curve->num_bytes, curve->num_bytes);
+#endif
+    if (!uECC_valid_point(points, curve)) {
+        return 0;
+    }
+
+    /* twice = 2Q, in affine form so that it shares Z = 1 with each odd multiple. */
+    uECC_vli_set(twice_x, points, num_words);
+    uECC_vli_set(twice_y, points + num_words, num_words);
+    uECC_vli_clear(z, num_words);
+    z[0] = 1;
+    curve->double_jacobian(twice_x, twice_y, z, curve);
+    uECC_vli_modInv(z, z, curve->p, num_words);
+    apply_z(twice_x, twice_y, z, curve);
+
+    /* (2j + 1)Q = (2j - 1)Q + 2Q. Q has prime order n, so the x coordinates never match. */
+    for (j = 1; j < uECC_PREPARED_POINTS; ++j) {
+        uECC_word_t *point = points + j * 2 * num_words;
+        uECC_vli_set(point, point - 2 * num_words, num_words);
+        uECC_vli_set(point + num_words, point - num_words, num_words);
+        uECC_vli_set(tx, twice_x, num_words);
+        uECC_vli_set(ty, twice_y, num_words);
+        uECC_vli_modSub(z, point, tx, curve->p, num_words); /* Z = x2 - x1 */
+        XYcZ_add(tx, ty, point, point + num_words, curve);
+        uECC_vli_modInv(z, z, curve->p, num_words);
+        apply_z(point, point + num_words, z, curve);
+    }
+
+    prepared->curve = curve;
+    return 1;
+}
+
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV
+/* Sets rx and z to the X and Z coordinates of u1*G + u2*Q on secp256k1, as in mult_prepared()
+   but with both scalars split by the endomorphism: four non-adjacent forms of about 128 digits,
+   for G, lambda * G, Q and lambda * Q, share half as many doublings. q_points holds the
+   2^(q_width - 2) affine odd multiples Q, 3Q, ... that the width-q_width form of the Q halves
+   indexes; lambda * (x, y) = (beta * x, y) gives the other two tables, at one multiplication per
+   entry. Returns 0 if the sum is the point at infinity. Variable-time. */
+static uECC_word_t mult_glv_table(uECC_word_t *rx,
+                                  uECC_word_t *z,
+                                  const uECC_word_t *u1,
+                                  const uECC_word_t *u2,
+                                  const uECC_word_t *q_points,
+                                  unsigned q_width,
+                                  uECC_Curve curve) {
+    uECC_word_t ry[num_words_secp256k1];
+    uECC_word_t k[4][num_words_secp256k1];
+    uECC_word_t negative[4];
+    uECC_word_t lambda_g[GLV_ENTRIES * 2 * num_words_secp256k1];
+    uECC_word_t lambda_q[uECC_PREPARED_POINTS * 2 * num_words_secp256k1];
+    int8_t naf[4][uECC_MAX_WORDS * uECC_WORD_BITS + 1];
+#if uECC_FIXED_BASE_TABLES
+    const uECC_word_t *g_points = curve->G_table;
+#else
+    const uECC_word_t *g_points = curve->G;
+#endif
+    const uECC_word_t *tables[4] = {g_points, lambda_g, q_points, lambda_q};
+    unsigned widths[4] = {PREPARED_G_WIDTH, PREPARED_G_WIDTH, 0, 0};
+    uECC_word_t infinity = 1;
+    bitcount_t i;
+    unsigned j;
+    unsigned s;
+
+    widths[2] = widths[3] = q_width;
+    split_scalar_secp256k1(k[0], k[1], negative, u1);
+    split_scalar_secp256k1(k[2], k[3], negative + 2, u2);
+
+    for (j = 0; j < (1u << (q_width - 2)); ++j) {
+        uECC_word_t *entry = lambda_q + j * 2 * num_words_secp256k1;
+        uECC_vli_modMult_fast(entry, q_points + j * 2 * num_words_secp256k1, secp256k1_beta,
+                              curve);
+        uECC_vli_set(entry + num_words_secp256k1,
+                     q_points + (2 * j + 1) * num_words_secp256k1, num_words_secp256k1);
+    }
+    for (j = 0; j < (1u << (PREPARED_G_WIDTH - 2)); ++j) {
+        uECC_word_t *entry = lambda_g + j * 2 * num_words_secp256k1;
+        uECC_vli_modMult_fast(entry, g_points + j * 2 * num_words_secp256k1, secp256k1_beta,
+                              curve);
+        uECC_vli_set(entry + num_words_secp256k1,
+                     g_points + (2 * j + 1) * num_words_secp256k1, num_words_secp256k1);
+    }
+
+    for (s = 0; s < 4; ++s) {
+        vli_wnaf(naf[s], k[s], widths[s], curve);
+        if (negative[s]) {
+            for (i = 0; i <= 128; ++i) {
+                naf[s][i] = (int8_t)-naf[s][i];
+            }
+        }
+    }
+
+    /* The halves are below 2^128, so their forms end at digit 128. */
+    for (i = 128; i >= 0; --i) {
+        if (!infinity) {
+            curve->double_jacobian(rx, ry, z, curve);
+        }
+        for (s = 0; s < 4; ++s) {
+            if (naf[s][i]) {
+                add_table_point(rx, ry, z, &infinity, tables[s], naf[s][i], curve);
+            }
+        }
+    }
+    return !infinity;
+}
+
+/* mult_glv_table() for a plain public key: computes the odd multiples of point first. */
+static uECC_word_t mult_glv(uECC_word_t *rx,
+                            uECC_word_t *z,
+                            const uECC_word_t *u1,
+                            const uECC_word_t *u2,
+                            const uECC_word_t *point,
+                            uECC_Curve curve) {
+    uECC_word_t q_points[GLV_ENTRIES * 2 * num_words_secp256k1];
+
+    EccPoint_odd_multiples(q_points, point, curve);
+    return mult_glv_table(rx, z, u1, u2, q_points, GLV_WIDTH, curve);
+}
+#endif /* uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV */
+
+/* Sets rx and z to the X and Z coordinates of u1*G + u2*Q, for the key Q in prepared, by
+   interleaving the two non-adjacent forms so that they share their doublings; on secp256k1,
+   mult_glv_table() splits both scalars first. Returns 0 if the sum is the point at infinity. */
+static uECC_word_t mult_prepared(uECC_word_t *rx,
+                                 uECC_word_t *z,
+                                 const uECC_word_t *u1,
+                                 const uECC_word_t *u2,
+                                 const uECC_PreparedKey *prepared) {
+    uECC_Curve curve = prepared->curve;
+    uECC_word_t ry[uECC_MAX_WORDS];
+    int8_t naf_g[uECC_MAX_WORDS * uECC_WORD_BITS + 1];
+    int8_t naf_q[uECC_MAX_WORDS * uECC_WORD_BITS + 1];
+    uECC_word_t infinity = 1;
+#if uECC_FIXED_BASE_TABLES
+    const uECC_word_t *g_points = curve->G_table;
+#else
+    const uECC_word_t *g_points = curve->G;
+#endif
+    const uECC_word_t *q_points = prepared_points(prepared);
+    bitcount_t i;
+
+#if uECC_SUPPORTS_secp256k1 && uECC_SECP256K1_GLV
+    if (curve == &curve_secp256k1) {
+        return mult_glv_table(rx, z, u1, u2, q_points, PREPARED_Q_WIDTH, curve);
+    }
+#endif
+
+    vli_wnaf(naf_g, u1, PREPARED_G_WIDTH, curve);
+    vli_wnaf(naf_q, u2, PREPARED_Q_WIDTH, curve);
+    for (i = curve->num_n_bits; i >= 0; --i) {
+        if (!infinity) {
+            curve->double_jacobian(rx, ry, z, curve);
+        }
+        if (naf_g[i]) {
+            add_table_point(rx, ry, z, &infinity, g_points, naf_g[i], curve);
+        }
+        if (naf_q[i]) {
+            add_table_point(rx, ry, z, &infinity, q_points, naf_q[i], curve);
+        }
+    }
+    return !infinity;
+}
+
+
+/* Returns 1 if the Jacobian point with coordinates X and Z has an affine x coordinate equal to
+   r mod n. The affine x is below p, so it is r or r + n (or r + 2n, ...) while that is below p,
+   and x = v exactly when X = v * Z^2. That takes a multiplication per candidate, usually just
+   one, instead of an inversion of Z. */
+static int x_equals_r(const uECC_word_t *X,
+                      const uECC_word_t *Z,
+                      const uECC_word_t *r,
+                      uECC_Curve curve) {
+    uECC_word_t v[uECC_MAX_WORDS];
+    uECC_word_t z2[uECC_MAX_WORDS];
+    uECC_word_t t[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+
+    uECC_vli_set(v, r, num_n_words);
+    uECC_vli_modSquare_fast(z2, Z, curve);
+    for (;;) {
+        /* v must be below p; n can have more words than p (secp160r1). */
+        if (num_n_words > num_words && v[num_words] != 0) {
+            return 0;
+        }
+        if (uECC_vli_cmp_unsafe(curve->p, v, num_words) != 1) {
+            return 0;
+        }
+        uECC_vli_modMult_fast(t, v, z2, curve);
+        if (uECC_vli_equal(t, X, num_words)) {
+            return 1;
+        }
+        if (uECC_vli_add(v, v, curve->n, num_n_words)) {
+            return 0;
+        }
+    }
+}
+
+int uECC_verify_prepared(const uECC_PreparedKey *prepared,
+                         const uint8_t *message_hash,
+                         unsigned hash_size,
+                         const uint8_t *signature) {
+    uECC_Curve curve = prepared->curve;
+    uECC_word_t u1[uECC_MAX_WORDS], u2[uECC_MAX_WORDS];
+    uECC_word_t r[uECC_MAX_WORDS], s[uECC_MAX_WORDS];
+    uECC_word_t rx[uECC_MAX_WORDS];
+    uECC_word_t z[uECC_MAX_WORDS];
+
+    if (!decode_signature(r, s, signature, curve)) {
+        return 0;
+    }
+    uECC_vli_modInv(s, s, curve->n, BITS_TO_WORDS(curve->num_n_bits)); /* s = 1/s */
+    verify_scalars(u1, u2, r, s, message_hash, hash_size, curve);
+
+    return mult_prepared(rx, z, u1, u2, prepared) && x_equals_r(rx, z, r, curve);
+}
+
+/* point_mult_ifma() serves uECC_point_mult_batch() and, on secp256r1, uECC_verify_batch(). */
+#if (uECC_PLATFORM == uECC_x86_64) && (uECC_WORD_SIZE == 8) && defined(__GNUC__) && \
+    (uECC_ENABLE_VLI_API || uECC_SUPPORTS_secp256r1)
+    #include "asm_x86_64_ifma.inc"
+#endif
+
+#if asm_ifma && uECC_SUPPORTS_secp256r1
+/* Sets valid[indices[i]] for the batch signatures (r[i], 1 / s[i]) of uECC_verify_batch(),
+   with the u1 * G and u2 * Q products of the whole group computed by point_mult_ifma(), which
+   runs them 8 lanes at a time and shares their conversion to affine form. The two products
+   are then added as in mult_prepared(). Returns 0, leaving valid alone, if the CPU has no
+   AVX-512 IFMA. */
+static int verify_group_ifma(uint8_t *valid,
+                             uECC_word_t r[][uECC_MAX_WORDS],
+                             uECC_word_t s[][uECC_MAX_WORDS],
+                             const unsigned *indices,
+                             unsigned batch,
+                             const uECC_PreparedKey *const *keys,
+                             const uint8_t *message_hashes,
+                             unsigned hash_size,
+                             uECC_Curve curve) {
+    uECC_word_t points[2 * uECC_BATCH_SIZE * 2 * uECC_MAX_WORDS];
+    uECC_word_t products[2 * uECC_BATCH_SIZE * 2 * uECC_MAX_WORDS];
+    uECC_word_t scalars[2 * uECC_BATCH_SIZE * uECC_MAX_WORDS];
+    uECC_word_t rx[uECC_MAX_WORDS];
+    uECC_word_t ry[uECC_MAX_WORDS];
+    uECC_word_t z[uECC_MAX_WORDS];
+    wordcount_t num_words = curve->num_words;
+    wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    unsigned i;
+
+    if (!cpu_has_avx512ifma()) {
+        return 0;
+    }
+    for (i = 0; i < batch; ++i) {
+        uECC_word_t *point = points + 2 * i * 2 * num_words;
+        uECC_vli_set(point, curve->G, 2 * num_words);
+        uECC_vli_set(point + 2 * num_words, prepared_points(keys[indices[i]]), 2 * num_words);
+        verify_scalars(scalars + 2 * i * num_n_words, scalars + (2 * i + 1) * num_n_words,
+                       r[i], s[i], message_hashes + indices[i] * hash_size, hash_size, curve);
+    }
+    point_mult_ifma(products, points, scalars, 2 * batch, curve);
+
+    for (i = 0; i < batch; ++i) {
+        const uECC_word_t *product = products + 2 * i * 2 * num_words;
+        /* u1 may be 0; point_mult_ifma() returns (0, 0), which is not on the curve, for the
+           point at infinity. u2 * Q is never infinite, as 0 < u2 < n. */
+        uECC_word_t infinity = uECC_vli_isZero(product, 2 * num_words);
+        uECC_vli_set(rx, product, num_words);
+        uECC_vli_set(ry, product + num_words, num_words);
+        uECC_vli_clear(z, num_words);
+        z[0] = 1;
+        add_table_point(rx, ry, z, &infinity, product + 2 * num_words, 1, curve);
+        valid[indices[i]] = !infinity && x_equals_r(rx, z, r[i], curve);
+    }
+    return 1;
+}
+#endif /* asm_ifma && uECC_SUPPORTS_secp256r1 */
+
+unsigned uECC_verify_batch(const uECC_PreparedKey *const *keys,
+                           const uint8_t *message_hashes,
+                           unsigned hash_size,
+                           const uint8_t *signatures,
+                           unsigned count,
+                           uint8_t *valid) {
+    uECC_Curve curve;
+    uECC_word_t r[uECC_BATCH_SIZE][uECC_MAX_WORDS];
+    uECC_word_t s[uECC_BATCH_SIZE][uECC_MAX_WORDS];
+    unsigned indices[uECC_BATCH_SIZE];
+    uECC_word_t u1[uECC_MAX_WORDS], u2[uECC_MAX_WORDS];
+    uECC_word_t rx[uECC_MAX_WORDS];
+    uECC_word_t z[uECC_MAX_WORDS];
+    unsigned signature_size;
+    unsigned num_valid = 0;
+    unsigned start;
+
+    if (count == 0) {
+        return 0;
+    }
+    curve = keys[0]->curve;
+    signature_size = 2 * curve->num_bytes;
+
+    for (start = 0; start < count; start += uECC_BATCH_SIZE) {
+        unsigned end = (count - start < uECC_BATCH_SIZE ? count : start + uECC_BATCH_SIZE);
+        unsigned batch = 0;
+        unsigned i;
+
+        for (i = start; i < end; ++i) {
+            valid[i] = 0;
+            if (keys[i]->curve == curve &&
+                    decode_signature(r[batch], s[batch], signatures + i * signature_size, curve)) {
+                indices[batch++] = i;
+            }
+        }
+        if (batch == 0) {
+            continue;
+        }
+
+        /* s = 1/s for the whole batch at the cost of one inversion. */
+        vli_modInv_batch(s, batch, curve->n, BITS_TO_WORDS(curve->num_n_bits), curve);
+
+#if asm_ifma && uECC_SUPPORTS_secp256r1
+        /* The lanes hold five 52-bit limbs whatever the curve, so they only beat
+           mult_prepared() on secp256r1: the smaller curves are cheaper, and secp256k1 has
+           the GLV split. */
+        if (curve == &curve_secp256r1 &&
+                verify_group_ifma(valid, r, s, indices, batch, keys, message_hashes, hash_size,
+                                  curve)) {
+            for (i = 0; i < batch; ++i) {
+                num_valid += valid[indices[i]];
+            }
+            continue;
+        }
+#endif
+        for (i = 0; i < batch; ++i) {
+            unsigned index = indices[i];
+            verify_scalars(u1, u2, r[i], s[i], message_hashes + index * hash_size, hash_size,
+                           curve);
+            if (mult_prepared(rx, z, u1, u2, keys[index]) && x_equals_r(rx, z, r[i], curve)) {
+                valid[index] = 1;
+                ++num_valid;
+            }
+        }
+    }
+    return num_valid;
+}
+
 #if uECC_ENABLE_VLI_API
 
 unsigned uECC_curve_num_words(uECC_Curve curve) {
@@ -1631,4 +3017,24 @@ void uECC_point_mult(uECC_word_t *result,
     EccPoint_mult(result, point, p2[!carry], 0, curve->num_n_bits + 1, curve);
 }
 
+void uECC_point_mult_batch(uECC_word_t *results,
+                           const uECC_word_t *points,
+                           const uECC_word_t *scalars,
+                           unsigned count,
+                           uECC_Curve curve) {
+    const wordcount_t num_words = curve->num_words;
+    const wordcount_t num_n_words = BITS_TO_WORDS(curve->num_n_bits);
+    unsigned i;
+
+#if asm_ifma
+    if (point_mult_ifma(results, points, scalars, count, curve)) {
+        return;
+    }
+#endif
+    for (i = 0; i < count; ++i) {
+        uECC_point_mult(results + i * 2 * num_words, points + i * 2 * num_words,
+                        scalars + i * num_n_words, curve);
+    }
+}
+
 #endif /* uECC_ENABLE_VLI_API */
@@ -32,9 +32,14 @@ platform. */
 
 /* uECC_SQUARE_FUNC - If enabled (defined as nonzero), this will cause a specific function to be
 used for (scalar) squaring instead of the generic multiplication function. This can make things
-faster somewhat faster, but increases the code size. */
+faster somewhat faster, but increases the code size. It is enabled by default on x86-64, where
+the MULX squaring of asm_x86_64.inc makes point multiplications about 25% faster. */
 #ifndef uECC_SQUARE_FUNC
-    #define uECC_SQUARE_FUNC 0
+    #if defined(__x86_64__)
+        #define uECC_SQUARE_FUNC 1
+    #else
+        #define uECC_SQUARE_FUNC 0
+    #endif
 #endif
 
 /* uECC_VLI_NATIVE_LITTLE_ENDIAN - If enabled (defined as nonzero), this will switch to native
@@ -52,6 +57,44 @@ the same endianness. */
     #define uECC_VLI_NATIVE_LITTLE_ENDIAN 0
 #endif
 
+/* uECC_FIXED_BASE_TABLES - If enabled (defined as nonzero), multiplications of the generator
+(key generation and signing) use precomputed tables of multiples of G from fixed-base.inc
+instead of the generic point multiplication. This makes them several times faster, but adds
+about 32 KB of read-only data for each 256-bit curve (less for the smaller curves). */
+#ifndef uECC_FIXED_BASE_TABLES
+    #if __AVR__
+        #define uECC_FIXED_BASE_TABLES 0
+    #else
+        #define uECC_FIXED_BASE_TABLES 1
+    #endif
+#endif
+
+/* uECC_SAFEGCD_INVERSE - If enabled (defined as nonzero), modular inversions use the constant-time
+safegcd algorithm of Bernstein and Yang instead of the binary extended Euclidean algorithm. This
+is several times faster where 32- and 64-bit multiplications are cheap, but uses wide signed
+arithmetic that is slow on 8-bit platforms. */
+#ifndef uECC_SAFEGCD_INVERSE
+    #if __AVR__
+        #define uECC_SAFEGCD_INVERSE 0
+    #else
+        #define uECC_SAFEGCD_INVERSE 1
+    #endif
+#endif
+
+/* uECC_SECP256K1_GLV - If enabled (defined as nonzero), secp256k1 point multiplications (ECDH and
+uECC_verify()) use the curve's endomorphism (x, y) -> (beta * x, y) to split each scalar into two
+halves of about 128 bits, which halves the number of point doublings. */
+#ifndef uECC_SECP256K1_GLV
+    #define uECC_SECP256K1_GLV 1
+#endif
+
+/* uECC_BATCH_SIZE - The number of signatures or keys that uECC_verify_batch() and
+uECC_make_keys_batch() work on together. Each group shares one modular inversion, and needs
+about 4 * 32 bytes of stack per entry. */
+#ifndef uECC_BATCH_SIZE
+    #define uECC_BATCH_SIZE 8
+#endif
+
 /* Curve support selection. Set to 0 to remove that curve. */
 #ifndef uECC_SUPPORTS_secp160r1
     #define uECC_SUPPORTS_secp160r1 1
@@ -165,6 +208,33 @@ Returns 1 if the key pair was generated successfully, 0 if an error occurred.
 */
 int uECC_make_key(uint8_t *public_key, uint8_t *private_key, uECC_Curve curve);
 
+/* uECC_make_keys_batch() function.
+Create count public/private key pairs. Gives keys like count calls to uECC_make_key(), but draws
+the randomness for all of them in one RNG request and computes the public keys in groups of
+uECC_BATCH_SIZE that share one modular inversion (with uECC_FIXED_BASE_TABLES enabled).
+
+Inputs:
+    count - The number of key pairs to create.
+
+Outputs:
+    public_keys  - Will be filled in with the count public keys, back to back; each is the size
+                   described for uECC_make_key().
+    private_keys - Will be filled in with the count private keys, back to back; each is the size
+                   described for uECC_make_key(). It is also used as the buffer for the RNG request.
+
+With uECC_VLI_NATIVE_LITTLE_ENDIAN, every key is the native word array that uECC_make_key()
+writes, so the sizes above are rounded up to whole words of uECC_WORD_SIZE bytes: private key i
+starts at private_keys + i * (uECC_curve_private_key_size() rounded up), for example 24 bytes
+apart on secp160r1, and public key i at public_keys + i * 2 * (uECC_curve_public_key_size() / 2
+rounded up), with its y coordinate at the second of those two halves.
+
+Returns 1 if the key pairs were generated successfully, 0 if an error occurred.
+*/
+int uECC_make_keys_batch(unsigned count,
+                         uint8_t *public_keys,
+                         uint8_t *private_keys,
+                         uECC_Curve curve);
+
 /* uECC_shared_secret() function.
 Compute a shared secret given your secret key and someone else's public key.
 Note: It is recommended that you hash the result of uECC_shared_secret() before using it for
@@ -298,6 +368,30 @@ void finish_SHA256(uECC_HashContext *base, uint8_t *hash_result) {
     SHA256_HashContext ctx = {{&init_SHA256, &update_SHA256, &finish_SHA256, 64, 32, tmp}};
     uECC_sign_deterministic(key, message_hash, &ctx.uECC, signature);
 }
+
+save_state() and restore_state() are optional: set both or neither (a context with only one
+of them set is treated as having neither). If provided, save_state() copies the current hash
+state (after init_hash() and update_hash() of one block) into one of two slots, 0 or 1, and
+restore_state() makes a saved state current again, for example:
+
+typedef struct SHA256_HashContext {
+    uECC_HashContext uECC;
+    SHA256_CTX ctx;
+    SHA256_CTX saved[2];
+} SHA256_HashContext;
+
+void save_SHA256(const uECC_HashContext *base, unsigned slot) {
+    SHA256_HashContext *context = (SHA256_HashContext *)base;
+    context->saved[slot] = context->ctx;
+}
+
+void restore_SHA256(const uECC_HashContext *base, unsigned slot) {
+    SHA256_HashContext *context = (SHA256_HashContext *)base;
+    context->ctx = context->saved[slot];
+}
+
+uECC_sign_deterministic() then hashes the HMAC key pads (ipad and opad) once for each key
+instead of once for every HMAC it computes with that key.
 */
 typedef struct uECC_HashContext {
     void (*init_hash)(const struct uECC_HashContext *context);
@@ -308,6 +402,8 @@ typedef struct uECC_HashContext {
     unsigned block_size; /* Hash function block size in bytes, eg 64 for SHA-256. */
     unsigned result_size; /* Hash function result size in bytes, eg 32 for SHA-256. */
     uint8_t *tmp; /* Must point to a buffer of at least (2 * result_size + block_size) bytes. */
+    void (*save_state)(const struct uECC_HashContext *context, unsigned slot); /* Optional */
+    void (*restore_state)(const struct uECC_HashContext *context, unsigned slot); /* Optional */
 } uECC_HashContext;
 
 /* uECC_sign_deterministic() function.
@@ -358,6 +454,87 @@ int uECC_verify(const uint8_t *public_key,
                 const uint8_t *signature,
                 uECC_Curve curve);
 
+/* uECC_PreparedKey structure.
+A public key that has been decoded, validated and expanded by uECC_prepare_public_key() for use
+with uECC_verify_prepared(). It holds the odd multiples Q, 3Q, ..., 31Q of the key Q, which take
+the place of the per-call G + Q that uECC_verify() computes (about 1 KB per key). The contents are
+private to uECC.
+*/
+#define uECC_PREPARED_POINTS 16
+typedef struct uECC_PreparedKey {
+    uECC_Curve curve;
+    union {
+        uint8_t u8[uECC_PREPARED_POINTS * 64];
+        uint32_t u32[uECC_PREPARED_POINTS * 16];
+        uint64_t u64[uECC_PREPARED_POINTS * 8];
+    } points;
+} uECC_PreparedKey;
+
+/* uECC_prepare_public_key() function.
+Decode and validate a public key once for repeated uECC_verify_prepared() calls.
+
+Usage: If you verify many signatures against the same public key, prepare it once and keep the
+uECC_PreparedKey around; preparing costs about as much as a few verifications.
+
+Inputs:
+    public_key - The public key to prepare.
+
+Outputs:
+    prepared - Will be filled in with the prepared key.
+
+Returns 1 if the public key is valid, 0 if it is invalid.
+*/
+int uECC_prepare_public_key(const uint8_t *public_key,
+                            uECC_PreparedKey *prepared,
+                            uECC_Curve curve);
+
+/* uECC_verify_prepared() function.
+Verify an ECDSA signature against a key prepared with uECC_prepare_public_key(). Gives the same
+result as uECC_verify() on the original public key, but is faster.
+
+Inputs:
+    prepared     - The signer's prepared public key.
+    message_hash - The hash of the signed data.
+    hash_size    - The size of message_hash in bytes.
+    signature    - The signature value.
+
+Returns 1 if the signature is valid, 0 if it is invalid.
+*/
+int uECC_verify_prepared(const uECC_PreparedKey *prepared,
+                         const uint8_t *message_hash,
+                         unsigned hash_size,
+                         const uint8_t *signature);
+
+/* uECC_verify_batch() function.
+Verify a number of ECDSA signatures at once. Gives the same results as calling
+uECC_verify_prepared() on each. Groups of uECC_BATCH_SIZE signatures share the modular inversion
+of s, a few percent of a verification. On secp256r1 with AVX-512 IFMA, the u1 * G and u2 * Q
+products of a group are also computed together, eight at a time, which makes verification about
+1.5 times as fast. Otherwise each signature still needs its own two-scalar point multiplication
+(an ECDSA signature holds only the x coordinate of R, which rules out combining the checks), so
+this costs about the same as a loop of uECC_verify_prepared().
+
+Inputs:
+    keys           - The signers' prepared public keys; keys[i] is the key for signature i.
+                     Signatures by the same signer can share one prepared key. All keys must be
+                     on the same curve; signatures with a key on another curve are invalid.
+    message_hashes - The count hashes of the signed data, hash_size bytes each, back to back.
+    hash_size      - The size of each message hash in bytes.
+    signatures     - The count signature values, back to back.
+    count          - The number of signatures.
+
+Outputs:
+    valid - valid[i] will be set to 1 if signature i is valid, and to 0 if it is invalid.
+
+Returns the number of valid signatures.
+*/
+unsigned uECC_verify_batch(const uECC_PreparedKey *const *keys,
+                           const uint8_t *message_hashes,
+                           unsigned hash_size,
+                           const uint8_t *signatures,
+                           unsigned count,
+                           uint8_t *valid);
+
 #ifdef __cplusplus
 } /* end of extern "C" */
 #endif
@@ -119,7 +119,7 @@ void uECC_vli_modSquare(uECC_word_t *result,
 /* Computes result = left^2 % curve->p. */
 void uECC_vli_modSquare_fast(uECC_word_t *result, const uECC_word_t *left, uECC_Curve curve);
 
-/* Computes result = (1 / input) % mod.*/
+/* Computes result = (1 / input) % mod, for odd mod. */
 void uECC_vli_modInv(uECC_word_t *result,
                      const uECC_word_t *input,
                      const uECC_word_t *mod,
@@ -157,6 +157,16 @@ void uECC_point_mult(uECC_word_t *result,
                      const uECC_word_t *scalar,
                      uECC_Curve curve);
 
+/* Multiplies count points by their scalars, like count calls to uECC_point_mult(); the
+   points, results and scalars follow each other in their arrays. Where the CPU has AVX-512
+   IFMA, 8 points at a time are multiplied in parallel vector lanes. A scalar that is a
+   multiple of the curve order gives the point at infinity, represented as (0, 0). */
+void uECC_point_mult_batch(uECC_word_t *results,
+                           const uECC_word_t *points,
+                           const uECC_word_t *scalars,
+                           unsigned count,
+                           uECC_Curve curve);
+
 /* Generates a random integer in the range 0 < random < top.
    Both random and top have num_words words. */
 int uECC_generate_random_int(uECC_word_t *random,
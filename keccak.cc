@@ -0,0 +1,205 @@
+#include <cstring>
+#include "keccak.h"
+
+#define KECCAK_ROTL(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+static const uint64_t keccak_rc[24] =
+            {0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL,
+             0x8000000080008000ULL, 0x000000000000808bULL, 0x0000000080000001ULL,
+             0x8000000080008081ULL, 0x8000000000008009ULL, 0x000000000000008aULL,
+             0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+             0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL,
+             0x8000000000008003ULL, 0x8000000000008002ULL, 0x8000000000000080ULL,
+             0x000000000000800aULL, 0x800000008000000aULL, 0x8000000080008081ULL,
+             0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL};
+
+/* Rotation offsets and destinations of the combined rho and pi steps,
+ * following the lane visited after lane 1 */
+static const unsigned int keccak_rho[24] =
+            {1, 3, 6, 10, 15, 21, 28, 36, 45, 55, 2, 14,
+             27, 41, 56, 8, 25, 43, 62, 18, 39, 61, 20, 44};
+static const unsigned int keccak_pi[24] =
+            {10, 7, 11, 17, 18, 3, 5, 16, 8, 21, 24, 4,
+             15, 23, 19, 13, 12, 2, 20, 14, 22, 9, 6, 1};
+
+void keccak_f1600(uint64_t state[25])
+{
+    uint64_t bc[5];
+    uint64_t t;
+    int i, j, round;
+    for (round = 0; round < 24; round++) {
+        /* theta */
+        for (i = 0; i < 5; i++) {
+            bc[i] = state[i] ^ state[i + 5] ^ state[i + 10] ^ state[i + 15] ^ state[i + 20];
+        }
+        for (i = 0; i < 5; i++) {
+            t = bc[(i + 4) % 5] ^ KECCAK_ROTL(bc[(i + 1) % 5], 1);
+            for (j = 0; j < 25; j += 5) {
+                state[j + i] ^= t;
+            }
+        }
+        /* rho and pi */
+        t = state[1];
+        for (i = 0; i < 24; i++) {
+            j = keccak_pi[i];
+            bc[0] = state[j];
+            state[j] = KECCAK_ROTL(t, keccak_rho[i]);
+            t = bc[0];
+        }
+        /* chi */
+        for (j = 0; j < 25; j += 5) {
+            for (i = 0; i < 5; i++) {
+                bc[i] = state[j + i];
+            }
+            for (i = 0; i < 5; i++) {
+                state[j + i] ^= (~bc[(i + 1) % 5]) & bc[(i + 2) % 5];
+            }
+        }
+        /* iota */
+        state[0] ^= keccak_rc[round];
+    }
+}
+
+#if KECCAK_HAVE_X86
+void keccak_f1600_x4_avx2(uint64_t states[4 * 25], const uint64_t rc[24],
+                          const unsigned int rho[24], const unsigned int pi[24]);
+
+static bool keccak_use_avx2()
+{
+    static const bool use = __builtin_cpu_supports("avx2");
+    return use;
+}
+#endif
+
+void keccak_f1600_x4(uint64_t states[4 * 25])
+{
+#if KECCAK_HAVE_X86
+    if (keccak_use_avx2()) {
+        keccak_f1600_x4_avx2(states, keccak_rc, keccak_rho, keccak_pi);
+        return;
+    }
+#endif
+    uint64_t state[25];
+    for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < 25; i++) {
+            state[i] = states[4 * i + j];
+        }
+        keccak_f1600(state);
+        for (int i = 0; i < 25; i++) {
+            states[4 * i + j] = state[i];
+        }
+    }
+}
+
+/* Byte i of the rate portion lives in lane i / 8, little-endian */
+static void keccak_xor_byte(uint64_t *lane, unsigned int pos, uint8_t b)
+{
+    lane[pos / 8] ^= (uint64_t) b << (8 * (pos % 8));
+}
+
+static uint8_t keccak_get_byte(const uint64_t *lane, unsigned int pos)
+{
+    return (uint8_t) (lane[pos / 8] >> (8 * (pos % 8)));
+}
+
+void SHAKE::init(unsigned int rate)
+{
+    memset(m_state, 0, sizeof(m_state));
+    m_rate = rate;
+    m_pos = 0;
+    m_squeezing = false;
+}
+
+void SHAKE::absorb(const uint8_t *data, size_t len)
+{
+    for (size_t i = 0; i < len; i++) {
+        keccak_xor_byte(m_state, m_pos++, data[i]);
+        if (m_pos == m_rate) {
+            keccak_f1600(m_state);
+            m_pos = 0;
+        }
+    }
+}
+
+/* SHAKE domain separation (1111) followed by pad10*1 */
+void SHAKE::pad()
+{
+    keccak_xor_byte(m_state, m_pos, 0x1f);
+    keccak_xor_byte(m_state, m_rate - 1, 0x80);
+    keccak_f1600(m_state);
+    m_pos = 0;
+    m_squeezing = true;
+}
+
+void SHAKE::squeeze(uint8_t *out, size_t len)
+{
+    if (!m_squeezing)
+        pad();
+    for (size_t i = 0; i < len; i++) {
+        if (m_pos == m_rate) {
+            keccak_f1600(m_state);
+            m_pos = 0;
+        }
+        out[i] = keccak_get_byte(m_state, m_pos++);
+    }
+}
+
+SHAKEx4::SHAKEx4(unsigned int rate, const uint8_t *const in[4], size_t len)
+{
+    memset(m_states, 0, sizeof(m_states));
+    m_rate = rate;
+    uint64_t lanes[4][25];
+    unsigned int pos = 0;
+    memset(lanes, 0, sizeof(lanes));
+    for (size_t i = 0; i <= len; i++) {
+        if (i == len) {
+            for (int j = 0; j < 4; j++) {
+                keccak_xor_byte(lanes[j], pos, 0x1f);
+                keccak_xor_byte(lanes[j], rate - 1, 0x80);
+            }
+        } else {
+            for (int j = 0; j < 4; j++) {
+                keccak_xor_byte(lanes[j], pos, in[j][i]);
+            }
+        }
+        if (++pos == rate || i == len) {
+            for (int j = 0; j < 4; j++) {
+                for (unsigned int w = 0; w < rate / 8; w++) {
+                    m_states[4 * w + j] ^= lanes[j][w];
+                }
+            }
+            keccak_f1600_x4(m_states);
+            memset(lanes, 0, sizeof(lanes));
+            pos = 0;
+        }
+    }
+}
+
+void SHAKEx4::squeeze_blocks(uint8_t *const out[4], size_t block_nb)
+{
+    for (size_t b = 0; b < block_nb; b++) {
+        for (int j = 0; j < 4; j++) {
+            for (unsigned int w = 0; w < m_rate / 8; w++) {
+                uint64_t lane = m_states[4 * w + j];
+                for (int k = 0; k < 8; k++) {
+                    out[j][b * m_rate + 8 * w + k] = (uint8_t) (lane >> (8 * k));
+                }
+            }
+        }
+        keccak_f1600_x4(m_states);
+    }
+}
+
+void shake128(uint8_t *out, size_t outlen, const uint8_t *in, size_t inlen)
+{
+    SHAKE ctx(SHAKE::SHAKE128_RATE);
+    ctx.absorb(in, inlen);
+    ctx.squeeze(out, outlen);
+}
+
+void shake256(uint8_t *out, size_t outlen, const uint8_t *in, size_t inlen)
+{
+    SHAKE ctx(SHAKE::SHAKE256_RATE);
+    ctx.absorb(in, inlen);
+    ctx.squeeze(out, outlen);
+}
@@ -0,0 +1,58 @@
+#ifndef KECCAK_H
+#define KECCAK_H
+#include <cstddef>
+#include <stdint.h>
+
+/* x86 SIMD permutation (keccak_x86.cc) needs GCC-style target attributes */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define KECCAK_HAVE_X86 1
+#else
+#define KECCAK_HAVE_X86 0
+#endif
+
+/* Keccak-f[1600] on one state, or on four independent states stored
+ * lane-interleaved (word i of state j at states[4 * i + j]). The four-way
+ * form uses AVX2 when the CPU has it. */
+void keccak_f1600(uint64_t state[25]);
+void keccak_f1600_x4(uint64_t states[4 * 25]);
+
+/* SHAKE128 / SHAKE256 extendable-output functions (FIPS 202). absorb() may
+ * be called any number of times; the first squeeze() pads the input and
+ * every later call continues the same output stream. */
+class SHAKE
+{
+public:
+    static const unsigned int SHAKE128_RATE = 168;
+    static const unsigned int SHAKE256_RATE = 136;
+
+    explicit SHAKE(unsigned int rate = SHAKE256_RATE) { init(rate); }
+    void init(unsigned int rate);
+    void absorb(const uint8_t *data, size_t len);
+    void squeeze(uint8_t *out, size_t len);
+
+protected:
+    void pad();
+    uint64_t m_state[25];
+    unsigned int m_rate;
+    unsigned int m_pos;
+    bool m_squeezing;
+};
+
+/* Four SHAKE instances driven in lockstep: each absorbs one input of the same
+ * length, then whole rate-sized blocks are squeezed from all four at once. */
+class SHAKEx4
+{
+public:
+    SHAKEx4(unsigned int rate, const uint8_t *const in[4], size_t len);
+    unsigned int rate() const { return m_rate; }
+    void squeeze_blocks(uint8_t *const out[4], size_t block_nb);
+
+protected:
+    uint64_t m_states[4 * 25];
+    unsigned int m_rate;
+};
+
+void shake128(uint8_t *out, size_t outlen, const uint8_t *in, size_t inlen);
+void shake256(uint8_t *out, size_t outlen, const uint8_t *in, size_t inlen);
+
+#endif
@@ -0,0 +1,60 @@
+#include "keccak.h"
+
+#if KECCAK_HAVE_X86
+#include <immintrin.h>
+
+#define KECCAK_ROTL_V(x, n) \
+    _mm256_or_si256(_mm256_slli_epi64(x, n), _mm256_srli_epi64(x, 64 - (n)))
+
+/* Four interleaved Keccak-f[1600] states, one per 64-bit lane of each
+ * register; the step structure mirrors the scalar keccak_f1600(). */
+__attribute__((target("avx2")))
+void keccak_f1600_x4_avx2(uint64_t states[4 * 25], const uint64_t rc[24],
+                          const unsigned int rho[24], const unsigned int pi[24])
+{
+    __m256i s[25];
+    __m256i bc[5];
+    __m256i t;
+    int i, j, round;
+    for (i = 0; i < 25; i++) {
+        s[i] = _mm256_loadu_si256((const __m256i *) &states[4 * i]);
+    }
+    for (round = 0; round < 24; round++) {
+        /* theta */
+        for (i = 0; i < 5; i++) {
+            bc[i] = _mm256_xor_si256(_mm256_xor_si256(s[i], s[i + 5]),
+                    _mm256_xor_si256(_mm256_xor_si256(s[i + 10], s[i + 15]), s[i + 20]));
+        }
+        for (i = 0; i < 5; i++) {
+            t = _mm256_xor_si256(bc[(i + 4) % 5], KECCAK_ROTL_V(bc[(i + 1) % 5], 1));
+            for (j = 0; j < 25; j += 5) {
+                s[j + i] = _mm256_xor_si256(s[j + i], t);
+            }
+        }
+        /* rho and pi */
+        t = s[1];
+        for (i = 0; i < 24; i++) {
+            j = pi[i];
+            bc[0] = s[j];
+            s[j] = KECCAK_ROTL_V(t, rho[i]);
+            t = bc[0];
+        }
+        /* chi */
+        for (j = 0; j < 25; j += 5) {
+            for (i = 0; i < 5; i++) {
+                bc[i] = s[j + i];
+            }
+            for (i = 0; i < 5; i++) {
+                s[j + i] = _mm256_xor_si256(s[j + i],
+                           _mm256_andnot_si256(bc[(i + 1) % 5], bc[(i + 2) % 5]));
+            }
+        }
+        /* iota */
+        s[0] = _mm256_xor_si256(s[0], _mm256_set1_epi64x((long long) rc[round]));
+    }
+    for (i = 0; i < 25; i++) {
+        _mm256_storeu_si256((__m256i *) &states[4 * i], s[i]);
+    }
+}
+
+#endif /* KECCAK_HAVE_X86 */
@@ -1,205 +1,558 @@
 #include "rTesla.h"
 #include <random>
-#include <ctime>
+#include <algorithm>
+#include <numeric>
+#include <mutex>
+#include <thread>
 #include "ecc/uECC.h"
+#include "sha256.h"
+#include "bench.h"
+#include "phase.h"
 #include "stdint.h"
 
-
-#define NUM_MESSAGES 10000
-#define LENGTH_MESSAGE 500
-#define NUM_TRIALS 10000
-
-#define SCHEME_TYPE 0 // 0 for rTesla, 1 for Ecc
 static string charset = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ1234567890";
 
 static char getRandomChar(default_random_engine& generator){
-  uniform_int_distribution<int> dist(0, charset.length());
+  uniform_int_distribution<int> dist(0, charset.length() - 1);
   return charset[dist(generator)];
 }
 
-static string generateMessage(default_random_engine& generator) {
+static string generateMessage(default_random_engine& generator, unsigned int length) {
   string result;
-  result.resize(LENGTH_MESSAGE); 
+  result.resize(length);
 
-  for (int i = 0; i < LENGTH_MESSAGE; i++){
+  for (unsigned int i = 0; i < length; i++){
     result[i] = getRandomChar(generator);
-  } 
+  }
   return result;
 }
 
-static vector<string> generateMessages(default_random_engine& generator){
-  vector<string> results(NUM_MESSAGES);
+static vector<string> generateMessages(default_random_engine& generator, unsigned int count,
+                                       unsigned int length){
+  vector<string> results(count);
   for (unsigned int i = 0; i < results.size(); i++){
-    results[i] = generateMessage(generator);
+    results[i] = generateMessage(generator, length);
   }
   return results;
 }
 
+/* Command line settings; see usage() */
+struct Options {
+  string scheme;
+  RingTesla::ParameterSet params;
+  BenchConfig config;
+  unsigned int length;    /* message length in bytes */
+  unsigned int batch;     /* messages or keys per batch call, 0 to skip */
+  Sha256Prehash prehash;
+  unsigned int threads;   /* most workers for --scheme=scaling, 0 for one per CPU */
+  bool sharedKeys;        /* scaling workers sign and verify with one key */
+  bool pin;               /* pin scaling workers to CPUs */
+  BenchOutput output;
+  string trace;           /* Chrome trace of the phase timers, if built in */
+  unsigned int seed;      /* messages, keys and ECDSA nonces; see seedFor() */
+  bool fixedSeed;         /* seed came from --seed rather than the clock */
+  Options() : scheme("rtesla"), params(RingTesla::RING_TESLA_I), length(500), batch(256),
+              prehash(SHA256_PREHASH_SEQUENTIAL), threads(0), sharedKeys(false), pin(true),
+              seed(0), fixedSeed(false) {}
+};
+
+static void usage(const char* program){
+  cerr << "usage: " << program << " [options]" << endl
+       << "  --scheme=rtesla|ecdsa|sha256|compare|scaling" << endl
+       << "                                what to benchmark (default rtesla); compare runs" << endl
+       << "                                both RingTesla sets and every curve into one table;" << endl
+       << "                                scaling runs RingTesla and ECDSA on 1..N threads" << endl
+       << "  --params=I|II                 RingTesla parameter set for rtesla and scaling (default I)" << endl
+       << "  --length=N                    message length in bytes (default 500)" << endl
+       << "  --batch=N                     messages per batch call, 0 to skip (default 256)" << endl
+       << "  --prehash=sequential|tree     message prehash mode (default sequential)" << endl
+       << "  --threads=N                   most scaling workers, 0 for one per CPU (default 0)" << endl
+       << "  --keys=per-thread|shared      scaling sign/verify keys (default per-thread);" << endl
+       << "                                keygen workers always have their own state" << endl
+       << "  --pin=on|off                  pin scaling workers to CPUs (default on)" << endl
+       << "  --trace=FILE                  write the phase timers as Chrome trace JSON; needs" << endl
+       << "                                a PHASE_TIMING=1 build, which also prints per-phase" << endl
+       << "                                totals after the report" << endl
+       << "  --seed=N                      seed for messages, keys and ECDSA nonces, so a run" << endl
+       << "                                repeats the same work (default from the clock;" << endl
+       << "                                the seed used is shown in the report)" << endl;
+  benchCommonUsage(cerr);
+}
 
-static void keyGenBenchmarkTests(){
-  cout << "RING-TESLA TESTS: " << endl;
-  cout << "Running Benchmarks for KeyGen()" << endl;
-  cout << "---------------------------------------------------------" << endl;
-  RingTesla rT = RingTesla();
+/* Accepts --name=value and --name value */
+static bool parseOptions(int argc, char* argv[], Options& options){
+  vector<pair<string, string> > args;
+  if (!benchSplitArgs(argc, argv, args)){
+    return false;
+  }
+  for (unsigned int i = 0; i < args.size(); i++){
+    const string& name = args[i].first;
+    const string& value = args[i].second;
+    unsigned int number = 0;
+    bool isNumber = benchParseUnsigned(value, number);
+    if (name == "scheme" && (value == "rtesla" || value == "ecdsa" || value == "sha256" ||
+                             value == "compare" || value == "scaling")){
+      options.scheme = value;
+    } else if (name == "params" && (value == "I" || value == "II")){
+      options.params = value == "II" ? RingTesla::RING_TESLA_II : RingTesla::RING_TESLA_I;
+    } else if (name == "length" && isNumber){
+      options.length = number;
+    } else if (name == "batch" && isNumber){
+      options.batch = number;
+    } else if (name == "prehash" && (value == "sequential" || value == "tree")){
+      options.prehash = value == "tree" ? SHA256_PREHASH_TREE : SHA256_PREHASH_SEQUENTIAL;
+    } else if (name == "threads" && isNumber){
+      options.threads = number;
+    } else if (name == "keys" && (value == "per-thread" || value == "shared")){
+      options.sharedKeys = value == "shared";
+    } else if (name == "pin" && (value == "on" || value == "off")){
+      options.pin = value == "on";
+    } else if (name == "trace" && phase_enabled()){
+      options.trace = value;
+    } else if (name == "seed" && isNumber){
+      options.seed = number;
+      options.fixedSeed = true;
+    } else if (!benchCommonOption(name, value, options.config, options.output)){
+      cerr << "invalid option: --" << name << "=" << value << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+/* Everything random in a run is drawn from its own stream of the run's seed,
+ * so each stream stays the same when another one changes */
+enum SeedStream { SEED_MESSAGES, SEED_ECDSA, SEED_KEYGEN, SEED_SIGNER };
+
+/* A seed for stream, or for its k-th object when there are several */
+static unsigned int seedFor(const Options& options, SeedStream stream, unsigned int k = 0){
+  seed_seq seq = {options.seed, (unsigned int) stream, k};
+  unsigned int seed = 0;
+  seq.generate(&seed, &seed + 1);
+  return seed;
+}
 
-  clock_t begin = clock();
-  for (int i = 0; i < NUM_TRIALS; i++){
-    rT.genPublic();
-    rT.keyGen();
+/* uECC's random numbers (keys and signing nonces) from the run's seed. The
+ * engine is shared by every thread, so scaling runs replay only the sequence
+ * of draws, not which worker gets each one */
+static mutex ecdsaRngLock;
+static default_random_engine ecdsaRngEngine;
+
+static int ecdsaRng(uint8_t* dest, unsigned size){
+  lock_guard<mutex> guard(ecdsaRngLock);
+  uniform_int_distribution<int> dist(0, 255);
+  for (unsigned int i = 0; i < size; i++){
+    dest[i] = (uint8_t) dist(ecdsaRngEngine);
   }
-  clock_t end = clock();
-  double elapsed_secs = double(end - begin) / CLOCKS_PER_SEC;
-  cout << NUM_TRIALS << " calls to keyGen() takes: " << elapsed_secs << " seconds" << endl;
+  return 1;
 }
 
-static void signAndVerifyBenchmarkTests(vector<string>& messages){
-  clock_t begin;
-  clock_t end;
-  double elapsed_secs;
+static string ringTeslaName(RingTesla::ParameterSet set){
+  return set == RingTesla::RING_TESLA_II ? "rtesla-II" : "rtesla-I";
+}
 
-  RingTesla rT = RingTesla();
+/* keygen, sign and verify (and the batch calls when withBatch is set) of one
+ * RingTesla parameter set, named "<ringTeslaName> <operation>". Returns the
+ * key and signature sizes for the comparison table. */
+static BenchScheme ringTeslaBenchmarkTests(const Options& options, RingTesla::ParameterSet set,
+                                    vector<string>& messages, bool withBatch,
+                                    BenchReport& report){
+  const BenchConfig& config = options.config;
+  string name = ringTeslaName(set);
+  RingTesla keyGenRT = RingTesla(set);
+  keyGenRT.setSeed(seedFor(options, SEED_KEYGEN));
+  BenchResult result = benchRun(name + " keygen", config, [&](unsigned int) {
+    keyGenRT.genPublic();
+    keyGenRT.keyGen();
+    return true;
+  });
+  report.add(result);
+
+  RingTesla rT = RingTesla(set);
+  rT.setSeed(seedFor(options, SEED_SIGNER));
+  rT.setPrehash(options.prehash);
   rT.genPublic();
-  rT.keyGen(); 
+  rT.keyGen();
 
-  /* Benchmarks for signatures */
-  cout << "Running Benchmarks for Signing: " << endl;
-  cout << "-----------------------------------------------------------" << endl;
+  /* Signing is deterministic, so each message always takes the same number
+   * of attempts; their mean puts heap use per attempt in the report */
   vector<tuple<vector<int>, string> > signatures(messages.size());
-  begin = clock();
-  for (unsigned int i = 0; i < messages.size(); i++){
-    signatures[i] = rT.sign(messages[i]);
-  }
-  end = clock();
-  elapsed_secs = double(end - begin) / CLOCKS_PER_SEC;
-  cout << messages.size() << " calls to sign(): " << elapsed_secs << " seconds" << endl;
-
-  /* Benmarks for verification */
-  cout << "Running Benchmarks for Verifying: " << endl;
-  cout << "------------------------------------------------------------" << endl;
-  vector<bool> verifyResults(messages.size());
-  begin = clock();
-  for (unsigned int i = 0; i < messages.size(); i++){
-    verifyResults[i] = rT.verify(messages[i], get<0>(signatures[i]), get<1>(signatures[i]));
-  }
-  end = clock();
-  elapsed_secs = double(end - begin) / CLOCKS_PER_SEC;
-  cout << messages.size() << " calls to verify(): " << elapsed_secs << " seconds" << endl;
-
-  /* Soundness verification */
-  bool isSound = true;
-  for (unsigned int i = 0; i < verifyResults.size(); i++){
-    if (!verifyResults[i]){
-      isSound = false;
-	  cout << "verification nr. " << i << " failed." << endl;
+  vector<unsigned int> attempts(messages.size(), 0);
+  result = benchRun(name + " sign", config, [&](unsigned int i) {
+    signatures[i] = rT.sign(messages[i], &attempts[i]);
+    return true;
+  });
+  unsigned int used = min<size_t>(config.iterations, messages.size());
+  if (used > 0){
+    result.attemptsPerOp = accumulate(attempts.begin(), attempts.begin() + used, 0.0) / used;
+  }
+  report.add(result);
+
+  result = benchRun(name + " verify", config, [&](unsigned int i) {
+    return rT.verify(messages[i], get<0>(signatures[i]), get<1>(signatures[i]));
+  });
+  report.add(result);
+
+  BenchScheme scheme = {name, rT.publicKeySize(), rT.secretKeySize(), rT.signatureSize()};
+  if (!withBatch || options.batch == 0){
+    return scheme;
+  }
+  /* One sample per batch call; enough calls to cover the messages once */
+  unsigned int batch = options.batch;
+  BenchConfig batchConfig = config;
+  batchConfig.iterations = max(1u, config.iterations / batch);
+  batchConfig.warmup = min(config.warmup, 1u);
+  vector<vector<string> > batches(batchConfig.iterations);
+  for (unsigned int b = 0; b < batches.size(); b++){
+    for (unsigned int k = 0; k < batch; k++){
+      batches[b].push_back(messages[(b * batch + k) % messages.size()]);
     }
   }
-  cout << "-----------------------------------------------------------" << endl;
-  cout << "Soundness verification " << (isSound ? "passed." : "failed.") << endl;
+  vector<vector<tuple<vector<int>, string> > > batchSignatures(batches.size());
+  result = benchRun(name + " sign_batch", batchConfig, [&](unsigned int b) {
+    batchSignatures[b] = rT.signBatch(batches[b]);
+    return true;
+  }, batch);
+  report.add(result);
+
+  result = benchRun(name + " verify_batch", batchConfig, [&](unsigned int b) {
+    vector<bool> ok = rT.verifyBatch(batches[b], batchSignatures[b]);
+    return count(ok.begin(), ok.end(), false) == 0;
+  }, batch);
+  report.add(result);
+  return scheme;
 }
 
-static void testEcsda(default_random_engine& generator){
-  int c;
-  uint8_t priv[32] = {0};
-  uint8_t pub[64] = {0};
-  // uint8_t hash[64] = {0};
-
-  const struct uECC_Curve_t * curves[5];
-  int num_curves = 0;
+/* The curves compiled into micro-ecc, with their names */
+static vector<pair<string, uECC_Curve> > enabledCurves(){
+  vector<pair<string, uECC_Curve> > curves;
 #if uECC_SUPPORTS_secp160r1
-  curves[num_curves++] = uECC_secp160r1();
+  curves.push_back(make_pair("secp160r1", uECC_secp160r1()));
 #endif
 #if uECC_SUPPORTS_secp192r1
-  curves[num_curves++] = uECC_secp192r1();
+  curves.push_back(make_pair("secp192r1", uECC_secp192r1()));
 #endif
 #if uECC_SUPPORTS_secp224r1
-  curves[num_curves++] = uECC_secp224r1();
+  curves.push_back(make_pair("secp224r1", uECC_secp224r1()));
 #endif
 #if uECC_SUPPORTS_secp256r1
-  curves[num_curves++] = uECC_secp256r1();
+  curves.push_back(make_pair("secp256r1", uECC_secp256r1()));
 #endif
 #if uECC_SUPPORTS_secp256k1
-  curves[num_curves++] = uECC_secp256k1();
+  curves.push_back(make_pair("secp256k1", uECC_secp256k1()));
 #endif
+  return curves;
+}
 
-  uint8_t messages[NUM_TRIALS][LENGTH_MESSAGE];
-  for (int r = 0; r < NUM_TRIALS; r++){
-    for (int i = 0; i < LENGTH_MESSAGE; i++){
-      messages[r][i] = (uint8_t) getRandomChar(generator);
+/* keygen, sign and verify (and their batch calls when withBatch is set) on one
+ * curve, named "ecdsa <curve> <operation>". Sign and verify include
+ * prehashing the message. Returns the key and signature sizes for the
+ * comparison table. */
+static BenchScheme ecdsaBenchmarkTests(const Options& options, const string& curveName, uECC_Curve curve,
+                                vector<string>& messages, bool withBatch, BenchReport& report){
+  const BenchConfig& config = options.config;
+  uint8_t priv[32];
+  uint8_t pub[64];
+  string name = "ecdsa " + curveName;
+
+  BenchResult result = benchRun(name + " keygen", config, [&](unsigned int) {
+    return uECC_make_key(pub, priv, curve) == 1;
+  });
+  report.add(result);
+
+  vector<vector<uint8_t> > signatures(messages.size(), vector<uint8_t>(64));
+  uECC_make_key(pub, priv, curve);
+  result = benchRun(name + " sign", config, [&](unsigned int i) {
+    PHASE_SCOPE("ecdsa sign");
+    PHASE_BEGIN(phase);
+    uint8_t hash[SHA256::DIGEST_SIZE];
+    sha256_prehash((const uint8_t*) messages[i].data(), messages[i].size(), hash,
+                   options.prehash);
+    PHASE_LAP("ecdsa sign: prehash", phase);
+    return uECC_sign(priv, hash, sizeof(hash), signatures[i].data(), curve) == 1;
+  });
+  report.add(result);
+
+  result = benchRun(name + " verify", config, [&](unsigned int i) {
+    PHASE_SCOPE("ecdsa verify");
+    PHASE_BEGIN(phase);
+    uint8_t hash[SHA256::DIGEST_SIZE];
+    sha256_prehash((const uint8_t*) messages[i].data(), messages[i].size(), hash,
+                   options.prehash);
+    PHASE_LAP("ecdsa verify: prehash", phase);
+    return uECC_verify(pub, hash, sizeof(hash), signatures[i].data(), curve) == 1;
+  });
+  report.add(result);
+
+  /* the key is prepared once, as a verifier that keeps seeing it would */
+  uECC_PreparedKey prepared;
+  uECC_prepare_public_key(pub, &prepared, curve);
+  result = benchRun(name + " verify prepared", config, [&](unsigned int i) {
+    PHASE_SCOPE("ecdsa verify prepared");
+    PHASE_BEGIN(phase);
+    uint8_t hash[SHA256::DIGEST_SIZE];
+    sha256_prehash((const uint8_t*) messages[i].data(), messages[i].size(), hash,
+                   options.prehash);
+    PHASE_LAP("ecdsa verify prepared: prehash", phase);
+    return uECC_verify_prepared(&prepared, hash, sizeof(hash), signatures[i].data()) == 1;
+  });
+  report.add(result);
+
+  /* a signature is r and s, each the size of a coordinate */
+  unsigned int publicKeyBytes = uECC_curve_public_key_size(curve);
+  BenchScheme scheme = {name, publicKeyBytes, (unsigned int) uECC_curve_private_key_size(curve),
+                        publicKeyBytes};
+  if (!withBatch || options.batch == 0){
+    return scheme;
+  }
+  /* One sample per batch call, as for RingTesla; uECC takes keys and
+   * signatures back to back, so signatures are packed outside the timed calls */
+  unsigned int batch = options.batch;
+  BenchConfig batchConfig = config;
+  batchConfig.iterations = max(1u, config.iterations / batch);
+  batchConfig.warmup = min(config.warmup, 1u);
+  vector<vector<uint8_t> > packed(batchConfig.iterations);
+  for (unsigned int b = 0; b < packed.size(); b++){
+    for (unsigned int k = 0; k < batch; k++){
+      const vector<uint8_t>& signature = signatures[(b * batch + k) % messages.size()];
+      packed[b].insert(packed[b].end(), signature.begin(), signature.begin() + publicKeyBytes);
     }
   }
-
-  /* For Timing */
-  clock_t begin;
-  clock_t end;
-  double elapsed_secs;
-
-  cout << "ECDSA TESTS: " << endl;
-  for (c = 0; c < num_curves; ++c) {
-    cout << "FOR CURVE NUMBER " << c << endl;
-    cout << "-------------------------------------------------" << endl;
-
-    cout << "Running Benchmarks for KeyGen()" << endl;
-    cout << "---------------------------------------------------------" << endl;
-    begin = clock();
-    for(int t = 0; t < NUM_TRIALS; t++){
-      if(!uECC_make_key(pub, priv, curves[c])){
-        cout << "Make key failed: curve " << c << endl;
-      }
+  vector<uint8_t> batchPubs(batch * publicKeyBytes);
+  vector<uint8_t> batchPrivs(batch * uECC_curve_private_key_size(curve));
+  result = benchRun(name + " keygen_batch", batchConfig, [&](unsigned int) {
+    return uECC_make_keys_batch(batch, batchPubs.data(), batchPrivs.data(), curve) == 1;
+  }, batch);
+  report.add(result);
+
+  vector<const uECC_PreparedKey*> keys(batch, &prepared);
+  vector<uint8_t> hashes(batch * SHA256::DIGEST_SIZE);
+  vector<uint8_t> valid(batch);
+  result = benchRun(name + " verify_batch", batchConfig, [&](unsigned int b) {
+    PHASE_SCOPE("ecdsa verify_batch");
+    for (unsigned int k = 0; k < batch; k++){
+      const string& message = messages[(b * batch + k) % messages.size()];
+      sha256_prehash((const uint8_t*) message.data(), message.size(),
+                     &hashes[k * SHA256::DIGEST_SIZE], options.prehash);
     }
-    end = clock();
-    elapsed_secs = double(end - begin) / CLOCKS_PER_SEC;
-    cout << NUM_TRIALS << " calls to keyGen() takes: " << elapsed_secs << " seconds" << endl;
-
-
-    /* Sign benchmark tests */
-
-    uint8_t signatures[NUM_TRIALS][64];
-    cout << "Running Benchmarks for Signing: " << endl;
-    cout << "-----------------------------------------------------------" << endl;
-    uECC_make_key(pub, priv, curves[c]);
-    begin = clock();
-    for(int t = 0; t < NUM_TRIALS; t++){
-      // if(!uECC_sign(priv, hash, sizeof(hash), signatures[t], curves[c])){
-      if(!uECC_sign(priv, messages[t], LENGTH_MESSAGE, signatures[t], curves[c])){     
-        cout << "Sign failed: curve " << c << endl;
-      }
+    return uECC_verify_batch(keys.data(), hashes.data(), SHA256::DIGEST_SIZE, packed[b].data(),
+                             batch, valid.data()) == batch;
+  }, batch);
+  report.add(result);
+  return scheme;
+}
+
+static void sha256BenchmarkTests(const Options& options, BenchReport& report){
+  const unsigned int sizes[] = {64, 1024, 16384, 1 << 20};
+  const SHA256::Backend backends[] = {SHA256::BACKEND_GENERIC, SHA256::BACKEND_AVX2,
+                                      SHA256::BACKEND_SHANI};
+  SHA256::Backend original = SHA256::backend();
+  vector<unsigned char> buffer(sizes[3], 0xa5);
+  unsigned char digest[SHA256::DIGEST_SIZE];
+
+  for (unsigned int b = 0; b < sizeof(backends) / sizeof(backends[0]); b++){
+    if (!SHA256::set_backend(backends[b])){
+      cerr << SHA256::backend_name(backends[b]) << ": not supported on this CPU" << endl;
+      continue;
     }
-    end = clock();
-    elapsed_secs = double(end - begin) / CLOCKS_PER_SEC;
-    cout << NUM_TRIALS << " calls to sign(): " << elapsed_secs << " seconds" << endl;
-
-    // /* Verify benchmark tests */
-    begin = clock();
-    for(int t = 0; t < NUM_TRIALS; t++){
-      // if(!uECC_verify(pub, hash, sizeof(hash), signatures[t], curves[c])){
-      if(!uECC_verify(pub, messages[t], LENGTH_MESSAGE, signatures[t], curves[c])){
-        cout << "Verify failed: curve " << c << endl;
-      }
+    for (unsigned int s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++){
+      string name = string("sha256 ") + SHA256::backend_name(backends[b]) + " " +
+                    to_string(sizes[s]) + "B";
+      BenchResult result = benchRun(name, options.config, [&](unsigned int) {
+        sha256_digest(buffer.data(), sizes[s], digest);
+        return true;
+      });
+      result.unitsPerOp = sizes[s];
+      result.unit = "B";
+      report.add(result);
     }
-    end = clock();
-    elapsed_secs = double(end - begin) / CLOCKS_PER_SEC;   
-    cout << NUM_TRIALS << " calls to verify(): " << elapsed_secs << " seconds" << endl;
   }
-
-
+  SHA256::set_backend(original);
 }
 
-int main(int argc, char *argv[]) {
-  unsigned timeSeed = chrono::system_clock::now().time_since_epoch().count();
-  default_random_engine generator(timeSeed);
-  vector<string> messages = generateMessages(generator);
-
-  if(SCHEME_TYPE == 0){
-    keyGenBenchmarkTests();
-    signAndVerifyBenchmarkTests(messages);
-  }else if(SCHEME_TYPE == 1){
-    testEcsda(generator);
+/* 1, 2, 4, ... below maxThreads, then maxThreads */
+static vector<unsigned int> threadCounts(unsigned int maxThreads){
+  vector<unsigned int> counts;
+  for (unsigned int t = 1; t < maxThreads; t *= 2){
+    counts.push_back(t);
   }
-
+  counts.push_back(maxThreads);
+  return counts;
 }
 
+/* keygen, sign and verify of one RingTesla set on each thread count, named
+ * "<ringTeslaName> <operation>". keyGen() draws from the object's own
+ * generator, so every keygen worker has its own object; signers are one
+ * per worker, or one shared by all with --keys=shared. */
+static void ringTeslaScalingTests(const Options& options, vector<string>& messages,
+                                  const vector<unsigned int>& counts, BenchReport& report){
+  const BenchConfig& config = options.config;
+  string name = ringTeslaName(options.params);
+  unsigned int maxThreads = counts.back();
+  vector<RingTesla> keyGenRT;
+  vector<RingTesla> signers;
+  for (unsigned int t = 0; t < maxThreads; t++){
+    keyGenRT.push_back(RingTesla(options.params));
+    keyGenRT.back().setSeed(seedFor(options, SEED_KEYGEN, t));
+    if (t == 0 || !options.sharedKeys){
+      signers.push_back(RingTesla(options.params));
+      signers.back().setSeed(seedFor(options, SEED_SIGNER, t));
+      signers.back().setPrehash(options.prehash);
+      signers.back().genPublic();
+      signers.back().keyGen();
+    }
+  }
+  auto signer = [&](unsigned int t) -> RingTesla& {
+    return signers[options.sharedKeys ? 0 : t];
+  };
+  vector<vector<tuple<vector<int>, string> > > signatures(
+      maxThreads, vector<tuple<vector<int>, string> >(messages.size()));
+
+  for (unsigned int c = 0; c < counts.size(); c++){
+    BenchResult result = benchRunParallel(name + " keygen", config, counts[c], options.pin,
+                                          [&](unsigned int t, unsigned int) {
+      keyGenRT[t].genPublic();
+      keyGenRT[t].keyGen();
+      return true;
+    });
+    report.add(result);
+
+    result = benchRunParallel(name + " sign", config, counts[c], options.pin,
+                              [&](unsigned int t, unsigned int i) {
+      signatures[t][i] = signer(t).sign(messages[i]);
+      return true;
+    });
+    report.add(result);
+
+    result = benchRunParallel(name + " verify", config, counts[c], options.pin,
+                              [&](unsigned int t, unsigned int i) {
+      return signer(t).verify(messages[i], get<0>(signatures[t][i]), get<1>(signatures[t][i]));
+    });
+    report.add(result);
+  }
+}
 
+/* keygen, sign and verify on one curve for each thread count, named
+ * "ecdsa <curve> <operation>". Every worker draws from the shared uECC RNG. */
+static void ecdsaScalingTests(const Options& options, const string& curveName, uECC_Curve curve,
+                              vector<string>& messages, const vector<unsigned int>& counts,
+                              BenchReport& report){
+  const BenchConfig& config = options.config;
+  string name = "ecdsa " + curveName;
+  unsigned int maxThreads = counts.back();
+  unsigned int keys = options.sharedKeys ? 1 : maxThreads;
+  vector<vector<uint8_t> > privs(keys, vector<uint8_t>(32));
+  vector<vector<uint8_t> > pubs(keys, vector<uint8_t>(64));
+  for (unsigned int k = 0; k < keys; k++){
+    uECC_make_key(pubs[k].data(), privs[k].data(), curve);
+  }
+  vector<vector<uint8_t> > scratchPubs(maxThreads, vector<uint8_t>(64));
+  vector<vector<uint8_t> > scratchPrivs(maxThreads, vector<uint8_t>(32));
+  vector<vector<vector<uint8_t> > > signatures(
+      maxThreads, vector<vector<uint8_t> >(messages.size(), vector<uint8_t>(64)));
+
+  for (unsigned int c = 0; c < counts.size(); c++){
+    BenchResult result = benchRunParallel(name + " keygen", config, counts[c], options.pin,
+                                          [&](unsigned int t, unsigned int) {
+      return uECC_make_key(scratchPubs[t].data(), scratchPrivs[t].data(), curve) == 1;
+    });
+    report.add(result);
+
+    result = benchRunParallel(name + " sign", config, counts[c], options.pin,
+                              [&](unsigned int t, unsigned int i) {
+      uint8_t hash[SHA256::DIGEST_SIZE];
+      sha256_prehash((const uint8_t*) messages[i].data(), messages[i].size(), hash,
+                     options.prehash);
+      return uECC_sign(privs[options.sharedKeys ? 0 : t].data(), hash, sizeof(hash),
+                       signatures[t][i].data(), curve) == 1;
+    });
+    report.add(result);
+
+    result = benchRunParallel(name + " verify", config, counts[c], options.pin,
+                              [&](unsigned int t, unsigned int i) {
+      uint8_t hash[SHA256::DIGEST_SIZE];
+      sha256_prehash((const uint8_t*) messages[i].data(), messages[i].size(), hash,
+                     options.prehash);
+      return uECC_verify(pubs[options.sharedKeys ? 0 : t].data(), hash, sizeof(hash),
+                         signatures[t][i].data(), curve) == 1;
+    });
+    report.add(result);
+  }
+}
 
+int main(int argc, char *argv[]) {
+  Options options;
+  if (!parseOptions(argc, argv, options)){
+    usage(argv[0]);
+    return 2;
+  }
+  BenchClock::calibrate();
+  phase_trace(!options.trace.empty());
 
+  if (!options.fixedSeed){
+    options.seed = chrono::system_clock::now().time_since_epoch().count();
+  }
+  default_random_engine generator(seedFor(options, SEED_MESSAGES));
+  ecdsaRngEngine.seed(seedFor(options, SEED_ECDSA));
+  uECC_set_rng(&ecdsaRng);
+
+  BenchReport report(options.config);
+  report.setParameter("seed", to_string(options.seed));
+  report.setParameter("scheme", options.scheme);
+  report.setParameter("length", to_string(options.length));
+  report.setParameter("prehash", options.prehash == SHA256_PREHASH_TREE ? "tree" : "sequential");
+  vector<string> messages;
+  if (options.scheme != "sha256"){
+    messages = generateMessages(generator, options.config.iterations, options.length);
+  }
+  vector<pair<string, uECC_Curve> > curves = enabledCurves();
+  if (options.scheme == "rtesla"){
+    report.setParameter("params", ringTeslaName(options.params));
+    report.setParameter("batch", to_string(options.batch));
+    ringTeslaBenchmarkTests(options, options.params, messages, true, report);
+  }else if(options.scheme == "ecdsa"){
+    report.setParameter("batch", to_string(options.batch));
+    for (unsigned int c = 0; c < curves.size(); c++){
+      ecdsaBenchmarkTests(options, curves[c].first, curves[c].second, messages, true, report);
+    }
+  }else if(options.scheme == "sha256"){
+    sha256BenchmarkTests(options, report);
+  }else if(options.scheme == "compare"){
+    /* Every scheme signs the same messages; one row each */
+    report.addScheme(ringTeslaBenchmarkTests(options, RingTesla::RING_TESLA_I, messages,
+                                             false, report));
+    report.addScheme(ringTeslaBenchmarkTests(options, RingTesla::RING_TESLA_II, messages,
+                                             false, report));
+    for (unsigned int c = 0; c < curves.size(); c++){
+      report.addScheme(ecdsaBenchmarkTests(options, curves[c].first, curves[c].second,
+                                           messages, false, report));
+    }
+  }else if(options.scheme == "scaling"){
+    unsigned int maxThreads = options.threads;
+    if (maxThreads == 0){
+      maxThreads = max(1u, thread::hardware_concurrency());
+    }
+    vector<unsigned int> counts = threadCounts(maxThreads);
+    report.setParameter("params", ringTeslaName(options.params));
+    report.setParameter("threads", to_string(maxThreads));
+    report.setParameter("keys", options.sharedKeys ? "shared" : "per-thread");
+    report.setParameter("pin", !options.pin ? "off" : benchCanPin() ? "on" : "unsupported");
+    ringTeslaScalingTests(options, messages, counts, report);
+    for (unsigned int c = 0; c < curves.size(); c++){
+      ecdsaScalingTests(options, curves[c].first, curves[c].second, messages, counts, report);
+    }
+  }
 
-
+  int status = benchFinish(report, options.output);
+  if (phase_enabled()){
+    /* Phase timers include the warmup calls */
+    const BenchOutput& output = options.output;
+    ostream& out = output.path.empty() && output.format != BENCH_TEXT ? cerr : cout;
+    out << endl;
+    phase_report(out);
+    if (!options.trace.empty() && !phase_write_trace(options.trace)){
+      status = 1;
+    }
+  }
+  return status;
+}
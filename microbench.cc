@@ -0,0 +1,256 @@
+#include "rTesla.h"
+#include "sha256.h"
+#include "sha256_uecc.h"
+#include "bench.h"
+#define uECC_ENABLE_VLI_API 1
+#include "ecc/uECC_vli.h"
+
+/* Room for any supported curve's p, n or scalar */
+static const unsigned int maxWords = 40 / sizeof(uECC_word_t);
+
+/* Times the kernels behind keygen, sign and verify one at a time, so a
+ * regression in an end-to-end number can be traced to a single primitive.
+ * Links against a copy of uECC.c built with uECC_ENABLE_VLI_API. */
+class Microbench {
+public:
+  Microbench(const BenchConfig& config, const string& filter, BenchReport& report)
+    : config(config), filter(filter), report(report) {}
+  void ringTesla(RingTesla::ParameterSet set);
+  void sha256();
+  void ecc(const string& curveName, uECC_Curve curve);
+
+private:
+  const BenchConfig& config;
+  string filter;
+  BenchReport& report;
+  void run(const string& name, double units, const string& unit,
+           const function<bool(unsigned int)>& op);
+};
+
+/* Runs op unless its name does not contain the filter */
+void Microbench::run(const string& name, double units, const string& unit,
+                     const function<bool(unsigned int)>& op){
+  if (name.find(filter) == string::npos){
+    return;
+  }
+  BenchResult result = benchRun(name, config, op);
+  result.unitsPerOp = units;
+  result.unit = unit;
+  report.add(result);
+}
+
+void Microbench::ringTesla(RingTesla::ParameterSet set){
+  string prefix = set == RingTesla::RING_TESLA_II ? "rtesla-II " : "rtesla-I ";
+  RingTesla rT(set);
+  rT.genPublic();
+  rT.keyGen();
+  unsigned int n = rT.n;
+  vector<int>& s = get<0>(rT.sk);
+  vector<int>& e1 = get<1>(rT.sk);
+
+  /* Operands as sign() sees them on its first attempt */
+  string message(500, 'm');
+  unsigned char rhoPrime[RingTesla::seedBytes];
+  rT.deriveYSeed(message, rhoPrime);
+  vector<int> y = rT.sampleZqPolynomial(rhoPrime, 0, true);
+  vector<int> v1 = rT.multiplyPolynomials(rT.a1, y);
+  rT.performModQ(v1);
+  vector<int> v2 = rT.multiplyPolynomials(rT.a2, y);
+  rT.performModQ(v2);
+  unsigned char digest[SHA256::DIGEST_SIZE];
+  rT.hash(message, v1, v2, digest);
+  vector<int> c = rT.encoding(digest);
+  vector<int> s_c = rT.multiplyPolynomials(s, c);
+  vector<int> z = rT.addPolynomials(y, s_c);
+  vector<int> e1_c = rT.multiplyPolynomials(e1, c);
+  vector<int> w1 = rT.subtractPolynomials(v1, e1_c);
+  rT.performModQ(w1);
+  vector<int> scratch;
+  unsigned int hashBytes = rT.hashInput(message, v1, v2).size();
+
+  run(prefix + "multiplyPolynomials dense", n, "coeff", [&](unsigned int) {
+    scratch = rT.multiplyPolynomials(rT.a1, y);
+    return true;
+  });
+  run(prefix + "multiplyPolynomials sparse", n, "coeff", [&](unsigned int) {
+    scratch = rT.multiplyPolynomials(s, c);
+    return true;
+  });
+  run(prefix + "performModQ", n, "coeff", [&](unsigned int) {
+    rT.performModQ(v1);
+    return true;
+  });
+  run(prefix + "addPolynomials", n, "coeff", [&](unsigned int) {
+    scratch = rT.addPolynomials(y, s_c);
+    return true;
+  });
+  run(prefix + "subtractPolynomials", n, "coeff", [&](unsigned int) {
+    scratch = rT.subtractPolynomials(v1, e1_c);
+    return true;
+  });
+  run(prefix + "sampleZqPolynomial y", n, "coeff", [&](unsigned int i) {
+    scratch = rT.sampleZqPolynomial(rhoPrime, i, true);
+    return true;
+  });
+  run(prefix + "sampleZqPolynomial a", n, "coeff", [&](unsigned int i) {
+    scratch = rT.sampleZqPolynomial(rT.publicSeed, i, false);
+    return true;
+  });
+  run(prefix + "sampleGaussianPolynomial", n, "coeff", [&](unsigned int) {
+    scratch = rT.sampleGaussianPolynomial();
+    return true;
+  });
+  run(prefix + "checkW", n, "coeff", [&](unsigned int) {
+    return rT.checkW(w1);
+  });
+  run(prefix + "checkZ", n, "coeff", [&](unsigned int) {
+    return rT.checkZ(z);
+  });
+  /* checkE reorders its argument, so each call starts from a fresh copy */
+  run(prefix + "checkE", n, "coeff", [&](unsigned int) {
+    scratch = e1;
+    return !rT.checkE(scratch);
+  });
+  run(prefix + "encoding", n, "coeff", [&](unsigned int) {
+    scratch = rT.encoding(digest);
+    return true;
+  });
+  run(prefix + "hash", hashBytes, "B", [&](unsigned int) {
+    rT.hash(message, v1, v2, digest);
+    return true;
+  });
+}
+
+void Microbench::sha256(){
+  const SHA256::Backend backends[] = {SHA256::BACKEND_GENERIC, SHA256::BACKEND_AVX2,
+                                      SHA256::BACKEND_SHANI};
+  unsigned char block[64] = {0};
+  SHA256 ctx;
+  for (unsigned int b = 0; b < sizeof(backends) / sizeof(backends[0]); b++){
+    if (!SHA256::backend_supported(backends[b])){
+      continue;
+    }
+    SHA256::transform_fn transform = SHA256::backend_transform(backends[b]);
+    run(string("SHA256::transform ") + SHA256::backend_name(backends[b]), 64, "B",
+        [&](unsigned int) {
+      transform(ctx.m_h, block, 1);
+      return true;
+    });
+  }
+}
+
+void Microbench::ecc(const string& curveName, uECC_Curve curve){
+  string prefix = "ecc " + curveName + " ";
+  wordcount_t words = uECC_curve_num_words(curve);
+  uECC_word_t left[maxWords], right[maxWords], result[maxWords];
+  uECC_word_t scalar[maxWords];
+  uECC_word_t point[2 * maxWords];
+  uECC_generate_random_int(left, uECC_curve_p(curve), words);
+  uECC_generate_random_int(right, uECC_curve_p(curve), words);
+  uECC_generate_random_int(scalar, uECC_curve_n(curve), uECC_curve_num_n_words(curve));
+
+  run(prefix + "uECC_vli_modMult_fast", uECC_curve_num_bits(curve), "bit", [&](unsigned int) {
+    uECC_vli_modMult_fast(result, left, right, curve);
+    return true;
+  });
+  run(prefix + "uECC_vli_modInv", uECC_curve_num_bits(curve), "bit", [&](unsigned int) {
+    uECC_vli_modInv(result, left, uECC_curve_p(curve), words);
+    return true;
+  });
+  run(prefix + "uECC_vli_modInv n", uECC_curve_num_n_bits(curve), "bit", [&](unsigned int) {
+    uECC_vli_modInv(result, scalar, uECC_curve_n(curve), uECC_curve_num_n_words(curve));
+    return true;
+  });
+  run(prefix + "EccPoint_mult", uECC_curve_num_n_bits(curve), "bit", [&](unsigned int) {
+    uECC_point_mult(point, uECC_curve_G(curve), scalar, curve);
+    return true;
+  });
+
+  /* A full group of the 8-lane IFMA code, where the CPU has it */
+  const unsigned batch = 8;
+  wordcount_t nWords = uECC_curve_num_n_words(curve);
+  vector<uECC_word_t> points(batch * 2 * words), scalars(batch * nWords), results(points.size());
+  for (unsigned i = 0; i < batch; i++){
+    uECC_vli_set(&points[i * 2 * words], uECC_curve_G(curve), 2 * words);
+    uECC_generate_random_int(&scalars[i * nWords], uECC_curve_n(curve), nWords);
+  }
+  run(prefix + "uECC_point_mult_batch", batch * uECC_curve_num_n_bits(curve), "bit",
+      [&](unsigned int) {
+    uECC_point_mult_batch(&results[0], &points[0], &scalars[0], batch, curve);
+    return true;
+  });
+
+  /* RFC 6979 signing with the SHA256 context, keeping the HMAC key states
+   * between HMACs under the same K or rehashing the pads every time */
+  vector<uint8_t> priv(uECC_curve_private_key_size(curve));
+  vector<uint8_t> pub(uECC_curve_public_key_size(curve));
+  vector<uint8_t> signature(2 * uECC_curve_num_bytes(curve));
+  uint8_t hash[SHA256::DIGEST_SIZE];
+  uECC_make_key(&pub[0], &priv[0], curve);
+  sha256_digest(&pub[0], pub.size(), hash);
+  for (int cached = 1; cached >= 0; cached--){
+    SHA256HashContext hashContext(cached);
+    run(prefix + (cached ? "uECC_sign_deterministic" : "uECC_sign_deterministic no key cache"),
+        1, "sig", [&](unsigned int) {
+      return uECC_sign_deterministic(&priv[0], hash, sizeof(hash), &hashContext.uECC,
+                                     &signature[0], curve) == 1;
+    });
+  }
+}
+
+static void usage(const char* program){
+  cerr << "usage: " << program << " [options]" << endl
+       << "  --filter=TEXT                 only kernels whose name contains TEXT" << endl
+       << "  --params=I|II                 RingTesla parameter set (default I)" << endl;
+  benchCommonUsage(cerr);
+}
+
+int main(int argc, char *argv[]){
+  BenchConfig config;
+  BenchOutput output;
+  string filter;
+  RingTesla::ParameterSet params = RingTesla::RING_TESLA_I;
+  vector<pair<string, string> > args;
+  bool valid = benchSplitArgs(argc, argv, args);
+  for (unsigned int i = 0; valid && i < args.size(); i++){
+    const string& name = args[i].first;
+    const string& value = args[i].second;
+    if (name == "filter"){
+      filter = value;
+    } else if (name == "params" && (value == "I" || value == "II")){
+      params = value == "II" ? RingTesla::RING_TESLA_II : RingTesla::RING_TESLA_I;
+    } else if (!benchCommonOption(name, value, config, output)){
+      cerr << "invalid option: --" << name << "=" << value << endl;
+      valid = false;
+    }
+  }
+  if (!valid){
+    usage(argv[0]);
+    return 2;
+  }
+  BenchClock::calibrate();
+
+  BenchReport report(config);
+  if (!filter.empty()){
+    report.setParameter("filter", filter);
+  }
+  Microbench bench(config, filter, report);
+  bench.ringTesla(params);
+  bench.sha256();
+#if uECC_SUPPORTS_secp160r1
+  bench.ecc("secp160r1", uECC_secp160r1());
+#endif
+#if uECC_SUPPORTS_secp192r1
+  bench.ecc("secp192r1", uECC_secp192r1());
+#endif
+#if uECC_SUPPORTS_secp224r1
+  bench.ecc("secp224r1", uECC_secp224r1());
+#endif
+#if uECC_SUPPORTS_secp256r1
+  bench.ecc("secp256r1", uECC_secp256r1());
+#endif
+#if uECC_SUPPORTS_secp256k1
+  bench.ecc("secp256k1", uECC_secp256k1());
+#endif
+  return benchFinish(report, output);
+}
@@ -0,0 +1,188 @@
+#include "phase.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+using namespace std;
+
+struct PhaseTotals {
+  const char* name;
+  uint64_t calls;
+  uint64_t totalNs;
+  uint64_t minNs;
+  uint64_t maxNs;
+};
+
+/* One timed interval, kept for the trace */
+struct PhaseEvent {
+  const char* name;
+  uint64_t begin;
+  uint64_t end;
+  unsigned int thread;
+  unsigned int attempt; /* 0 unless recorded by phase_attempt() */
+};
+
+/* Beyond this many events the trace stops growing; totals stay exact */
+static const size_t phaseMaxEvents = 1 << 20;
+
+static mutex phaseLock;
+static vector<PhaseTotals> phaseTotals; /* in order of first appearance */
+static vector<PhaseTotals> phaseAttempts; /* index attempt - 1; name is the attempt's */
+static vector<PhaseEvent> phaseEvents;
+static bool phaseTracing = false;
+static const chrono::steady_clock::time_point phaseEpoch = chrono::steady_clock::now();
+
+/* Small per-thread ids for the trace */
+static unsigned int phaseThread(){
+  static atomic<unsigned int> next(0);
+  static thread_local unsigned int id = next++;
+  return id;
+}
+
+static void phaseAdd(PhaseTotals& totals, uint64_t ns){
+  totals.calls++;
+  totals.totalNs += ns;
+  totals.minNs = totals.calls == 1 ? ns : min(totals.minNs, ns);
+  totals.maxNs = max(totals.maxNs, ns);
+}
+
+static PhaseTotals& phaseFind(vector<PhaseTotals>& list, const char* name){
+  for (size_t i = 0; i < list.size(); i++){
+    if (list[i].name == name || strcmp(list[i].name, name) == 0){
+      return list[i];
+    }
+  }
+  PhaseTotals totals = {name, 0, 0, 0, 0};
+  list.push_back(totals);
+  return list.back();
+}
+
+static void phaseRecord(const char* name, unsigned int attempt, uint64_t begin, uint64_t end){
+  unsigned int thread = phaseThread();
+  lock_guard<mutex> guard(phaseLock);
+  if (attempt == 0){
+    phaseAdd(phaseFind(phaseTotals, name), end - begin);
+  } else {
+    if (phaseAttempts.size() < attempt){
+      PhaseTotals empty = {name, 0, 0, 0, 0};
+      phaseAttempts.resize(attempt, empty);
+    }
+    phaseAdd(phaseAttempts[attempt - 1], end - begin);
+  }
+  if (phaseTracing && phaseEvents.size() < phaseMaxEvents){
+    PhaseEvent event = {name, begin, end, thread, attempt};
+    phaseEvents.push_back(event);
+  }
+}
+
+extern "C" uint64_t phase_now(void){
+  return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() -
+                                                    phaseEpoch).count();
+}
+
+extern "C" uint64_t phase_lap(const char *name, uint64_t begin){
+  uint64_t end = phase_now();
+  phaseRecord(name, 0, begin, end);
+  return end;
+}
+
+extern "C" void phase_attempt(const char *name, unsigned int attempt, uint64_t begin){
+  phaseRecord(name, attempt, begin, phase_now());
+}
+
+bool phase_enabled(){
+  return PHASE_TIMING;
+}
+
+void phase_reset(){
+  lock_guard<mutex> guard(phaseLock);
+  phaseTotals.clear();
+  phaseAttempts.clear();
+  phaseEvents.clear();
+}
+
+void phase_trace(bool on){
+  lock_guard<mutex> guard(phaseLock);
+  phaseTracing = on;
+}
+
+void phase_report(ostream& out){
+  lock_guard<mutex> guard(phaseLock);
+  size_t width = 5;
+  for (size_t i = 0; i < phaseTotals.size(); i++){
+    width = max(width, strlen(phaseTotals[i].name));
+  }
+  out << left << setw(width + 2) << "phase" << right << setw(10) << "calls"
+      << setw(12) << "total ms" << setw(12) << "mean us" << setw(12) << "min us"
+      << setw(12) << "max us" << setw(10) << "share" << endl;
+  out << string(width + 2 + 10 + 12 * 4 + 10, '-') << endl;
+  for (size_t i = 0; i < phaseTotals.size(); i++){
+    const PhaseTotals& p = phaseTotals[i];
+    out << left << setw(width + 2) << p.name << right << setw(10) << p.calls << fixed
+        << setprecision(3) << setw(12) << p.totalNs / 1e6
+        << setw(12) << p.totalNs / 1e3 / p.calls << setw(12) << p.minNs / 1e3
+        << setw(12) << p.maxNs / 1e3;
+    /* "parent: phase" as a share of "parent" */
+    const char* colon = strstr(p.name, ": ");
+    const PhaseTotals* parent = NULL;
+    for (size_t k = 0; colon && k < phaseTotals.size(); k++){
+      if (strlen(phaseTotals[k].name) == (size_t) (colon - p.name) &&
+          strncmp(phaseTotals[k].name, p.name, colon - p.name) == 0){
+        parent = &phaseTotals[k];
+      }
+    }
+    if (parent && parent->totalNs > 0){
+      ostringstream share;
+      share << fixed << setprecision(1) << 100.0 * p.totalNs / parent->totalNs << "%";
+      out << setw(10) << share.str();
+    } else {
+      out << setw(10) << "-";
+    }
+    out << endl;
+  }
+  if (phaseAttempts.empty()){
+    return;
+  }
+  out << endl << left << setw(width + 2) << "attempt" << right << setw(10) << "calls"
+      << setw(12) << "total ms" << setw(12) << "mean us" << setw(12) << "min us"
+      << setw(12) << "max us" << endl;
+  out << string(width + 2 + 10 + 12 * 4, '-') << endl;
+  for (size_t i = 0; i < phaseAttempts.size(); i++){
+    const PhaseTotals& p = phaseAttempts[i];
+    if (p.calls == 0){
+      continue;
+    }
+    out << left << setw(width + 2) << string(p.name) + " " + to_string(i + 1) << right
+        << setw(10) << p.calls << fixed << setprecision(3) << setw(12) << p.totalNs / 1e6
+        << setw(12) << p.totalNs / 1e3 / p.calls << setw(12) << p.minNs / 1e3
+        << setw(12) << p.maxNs / 1e3 << endl;
+  }
+}
+
+bool phase_write_trace(const string& path){
+  ofstream out(path.c_str());
+  lock_guard<mutex> guard(phaseLock);
+  /* Complete ("X") events; timestamps and durations in microseconds */
+  out << "{\"traceEvents\": [" << endl << fixed << setprecision(3);
+  for (size_t i = 0; i < phaseEvents.size(); i++){
+    const PhaseEvent& e = phaseEvents[i];
+    out << "  {\"name\": \"" << e.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.thread
+        << ", \"ts\": " << e.begin / 1e3 << ", \"dur\": " << (e.end - e.begin) / 1e3;
+    if (e.attempt){
+      out << ", \"args\": {\"attempt\": " << e.attempt << "}";
+    }
+    out << "}" << (i + 1 < phaseEvents.size() ? "," : "") << endl;
+  }
+  out << "], \"displayTimeUnit\": \"ns\"}" << endl;
+  if (!out){
+    cerr << "could not write " << path << endl;
+    return false;
+  }
+  return true;
+}
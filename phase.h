@@ -0,0 +1,87 @@
+#ifndef PHASE_H_
+#define PHASE_H_
+
+#include <stdint.h>
+
+/* Phase timers for profiling where keygen, sign and verify spend their time.
+ * They are compiled in only with PHASE_TIMING=1 (make PHASE_TIMING=1);
+ * otherwise every macro below expands to nothing.
+ *
+ *   PHASE_BEGIN(t);                      starts timer t
+ *   PHASE_LAP("sign: a*y", t);           records t..now and restarts t
+ *   PHASE_END("uECC EccPoint_mult", t);  records t..now
+ *   PHASE_ATTEMPT("sign attempt", n, t); records t..now as rejection attempt n
+ *   PHASE_SCOPE("sign");                 (C++) times the enclosing scope
+ *
+ * Names must be string literals; a name of the form "parent: phase" is
+ * reported as a share of the phase named "parent". */
+#ifndef PHASE_TIMING
+#define PHASE_TIMING 0
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint64_t phase_now(void);
+uint64_t phase_lap(const char *name, uint64_t begin);
+void phase_attempt(const char *name, unsigned int attempt, uint64_t begin);
+
+#ifdef __cplusplus
+}
+#endif
+
+#if PHASE_TIMING
+#define PHASE_BEGIN(t) uint64_t t = phase_now()
+#define PHASE_LAP(name, t) t = phase_lap(name, t)
+#define PHASE_END(name, t) (void) phase_lap(name, t)
+#define PHASE_ATTEMPT(name, attempt, t) phase_attempt(name, attempt, t)
+#else
+#define PHASE_BEGIN(t)
+#define PHASE_LAP(name, t)
+#define PHASE_END(name, t)
+#define PHASE_ATTEMPT(name, attempt, t)
+#endif
+
+#ifdef __cplusplus
+#include <iostream>
+#include <string>
+
+class PhaseScope {
+public:
+  explicit PhaseScope(const char* name) : name(name), begin(phase_now()) {}
+  ~PhaseScope(){phase_lap(name, begin);}
+
+private:
+  const char* name;
+  uint64_t begin;
+};
+
+#if PHASE_TIMING
+#define PHASE_CONCAT_(a, b) a##b
+#define PHASE_CONCAT(a, b) PHASE_CONCAT_(a, b)
+#define PHASE_SCOPE(name) PhaseScope PHASE_CONCAT(phaseScope, __LINE__)(name)
+#else
+#define PHASE_SCOPE(name)
+#endif
+
+/* Whether phase.cc was built with the timers, and so whether anything was
+ * recorded */
+bool phase_enabled();
+
+/* Forgets everything recorded so far */
+void phase_reset();
+
+/* Keeps every timed interval, not only the per-phase totals, for
+ * phase_write_trace(); off by default */
+void phase_trace(bool on);
+
+/* Per-phase calls, total, mean, min and max time, and the mean time of
+ * each rejection attempt */
+void phase_report(std::ostream& out);
+
+/* Chrome trace-event JSON, viewable in chrome://tracing or Perfetto */
+bool phase_write_trace(const std::string& path);
+#endif
+
+#endif
@@ -4,8 +4,10 @@
 #include <numeric>
 #include <functional>
 #include "sha256.h"
+#include "keccak.h"
+#include "phase.h"
 #include <string>
-#include <sstream>
+#include <cstring>
 
 // static void printVector(vector<int>& vec){
 //   for (unsigned int i = 0; i < vec.size(); i++){
@@ -14,55 +16,201 @@
 //   cout << endl; 
 // }
 
-RingTesla::RingTesla() {
-  // RingTesla-I parameters
-  n = 512;
-  w = 16; /* original paper set value to 11 */
-  sigma = 30;
-  B = (1 << 21) - 1;
-  d = 21;
-  U = 993;
-  L = 814;
-  q = 8399873;
-  lambda = 80;
-  kappa = 256;
-
-  // RingTesla-II parameters
-  // n = 512;
-  // w = 16; /* original paper set value to 19 */
-  // sigma = 52;
-  // B = (1 << 22) - 1;
-  // d = 23;
-  // U = 3173;
-  // L = 2766;
-  // q = 39960577;
-  // lambda = 128;
-  // kappa = 256;
-
-  generator.seed(timeSeed);
+RingTesla::RingTesla(ParameterSet set) {
+  if (set == RING_TESLA_II){
+    // RingTesla-II parameters
+    n = 512;
+    w = 16; /* original paper set value to 19 */
+    sigma = 52;
+    B = (1 << 22) - 1;
+    d = 23;
+    U = 3173;
+    L = 2766;
+    q = 39960577;
+    lambda = 128;
+    kappa = 256;
+  } else {
+    // RingTesla-I parameters
+    n = 512;
+    w = 16; /* original paper set value to 11 */
+    sigma = 30;
+    B = (1 << 21) - 1;
+    d = 21;
+    U = 993;
+    L = 814;
+    q = 8399873;
+    lambda = 80;
+    kappa = 256;
+  }
+
+  prehash = SHA256_PREHASH_SEQUENTIAL;
+  generator.seed(seed);
   q_inv = 1 / (double) q;
 }
 
 
-vector<int> RingTesla::sampleZqPolynomial(bool useB){
-  int minDist = useB ? (-1 * (int) B) : -1 * ceil(q / 2);
-  int maxDist = useB ? ((int) B) : floor(q / 2);
+/* Bits needed to store any value in [-bound, bound] */
+static unsigned int signedBits(uint32_t bound){
+  unsigned int bits = 1;
+  while ((1ULL << bits) < 2ULL * bound + 1){
+    bits++;
+  }
+  return bits;
+}
+
+/* t1 and t2 reduced mod q, plus the seed that expands to a1 and a2 */
+unsigned int RingTesla::publicKeySize(){
+  return (2 * n * signedBits(q / 2) + 7) / 8 + seedBytes;
+}
+
+/* s, e1 and e2 with Gaussian coefficients cut off at 14 sigma, plus ySeed */
+unsigned int RingTesla::secretKeySize(){
+  return (3 * n * signedBits(14 * sigma) + 7) / 8 + seedBytes;
+}
+
+/* z, whose coefficients checkZ() bounds by B - U, and the kappa-bit c' */
+unsigned int RingTesla::signatureSize(){
+  return (n * signedBits(B - U) + 7) / 8 + kappa / 8;
+}
+
+/* Fills seed with seedBytes bytes from the generator */
+void RingTesla::drawSeed(unsigned char* seed){
+  uniform_int_distribution<int> dist(0, 255);
+  for (unsigned int i = 0; i < seedBytes; i++){
+    seed[i] = (unsigned char) dist(generator);
+  }
+}
+
+/* Per-message seed for y: SHAKE256(ySeed || message). Signing is therefore
+ * deterministic, with the attempt number as the expansion nonce. */
+void RingTesla::deriveYSeed(string& message, unsigned char* rhoPrime){
+  SHAKE xof(SHAKE::SHAKE256_RATE);
+  xof.absorb(ySeed, seedBytes);
+  xof.absorb((const uint8_t*) message.data(), message.size());
+  xof.squeeze(rhoPrime, seedBytes);
+}
 
-  uniform_int_distribution<int> dist(minDist, maxDist);
+/* XOF input for one polynomial: seed || nonce (little-endian) */
+static void xofInput(unsigned char* in, const unsigned char* seed, unsigned int seedBytes,
+                     unsigned int nonce){
+  memcpy(in, seed, seedBytes);
+  for (int i = 0; i < 4; i++){
+    in[seedBytes + i] = (unsigned char) (nonce >> (8 * i));
+  }
+}
+
+/* Bytes per rejection-sampling candidate for values in [0, range) */
+static unsigned int candidateBytes(uint32_t range){
+  return range > (1U << 24) ? 4 : range > (1U << 16) ? 3 : 2;
+}
+
+/* Parses little-endian candidates from buf, masked to the bit length of range,
+ * and keeps those below range until out is full. Returns the number of bytes
+ * consumed; a trailing partial candidate is left for the next call. */
+static size_t rejectUniform(vector<int>& out, unsigned int& filled, const unsigned char* buf,
+                            size_t len, uint32_t range, int offset){
+  unsigned int bits = 0;
+  while ((1ULL << bits) < range){
+    bits++;
+  }
+  unsigned int bytes = candidateBytes(range);
+  uint32_t mask = (uint32_t) ((1ULL << bits) - 1);
+  size_t pos = 0;
+  while (filled < out.size() && pos + bytes <= len){
+    uint32_t x = 0;
+    for (unsigned int i = 0; i < bytes; i++){
+      x |= (uint32_t) buf[pos + i] << (8 * i);
+    }
+    pos += bytes;
+    x &= mask;
+    if (x < range){
+      out[filled++] = (int) x - offset;
+    }
+  }
+  return pos;
+}
+
+/* Expands seed and nonce into a polynomial with coefficients uniform in
+ * [-B, B] (useB) or [-(q/2), q/2]. Public polynomials use SHAKE128, the
+ * secret y uses SHAKE256. */
+vector<int> RingTesla::sampleZqPolynomial(const unsigned char* seed, unsigned int nonce, bool useB){
+  uint32_t range = useB ? 2 * B + 1 : q;
+  int offset = useB ? (int) B : (int) (q / 2);
+  unsigned char in[seedBytes + 4];
+  xofInput(in, seed, seedBytes, nonce);
+  SHAKE xof(useB ? SHAKE::SHAKE256_RATE : SHAKE::SHAKE128_RATE);
+  xof.absorb(in, sizeof(in));
 
   vector<int> result(n);
-  for (unsigned int i = 0; i < result.size(); i++){
-    result[i] = dist(generator);
+  unsigned int filled = 0;
+  unsigned char buf[4 * 64]; /* a whole number of candidates */
+  size_t chunk = candidateBytes(range) * 64;
+  while (filled < n){
+    xof.squeeze(buf, chunk);
+    rejectUniform(result, filled, buf, chunk, range, offset);
   }
   return result;
 }
 
+/* Four sampleZqPolynomial() expansions at once with the four-way Keccak
+ * permutation. Lanes whose result pointer is null are computed on the first
+ * seed and discarded. Each lane yields the same polynomial as the scalar
+ * sampler for its seed and nonce. */
+void RingTesla::sampleZqPolynomialsX4(const unsigned char* const seeds[4],
+                                      const unsigned int nonces[4], bool useB,
+                                      vector<int>* results[4]){
+  uint32_t range = useB ? 2 * B + 1 : q;
+  int offset = useB ? (int) B : (int) (q / 2);
+  unsigned char in[4][seedBytes + 4];
+  const uint8_t* ins[4];
+  for (int l = 0; l < 4; l++){
+    xofInput(in[l], results[l] ? seeds[l] : seeds[0], seedBytes, nonces[l]);
+    ins[l] = in[l];
+  }
+  SHAKEx4 xof(useB ? SHAKE::SHAKE256_RATE : SHAKE::SHAKE128_RATE, ins, seedBytes + 4);
+
+  /* Each lane's stream keeps any partial candidate across block boundaries */
+  vector<unsigned char> stream[4];
+  size_t pos[4] = {0, 0, 0, 0};
+  unsigned int filled[4] = {0, 0, 0, 0};
+  for (int l = 0; l < 4; l++){
+    if (results[l]){
+      results[l]->assign(n, 0);
+    }
+  }
+  while (true){
+    bool done = true;
+    for (int l = 0; l < 4; l++){
+      done = done && (!results[l] || filled[l] == n);
+    }
+    if (done){
+      break;
+    }
+    uint8_t* out[4];
+    for (int l = 0; l < 4; l++){
+      stream[l].resize(stream[l].size() + xof.rate());
+      out[l] = &stream[l][stream[l].size() - xof.rate()];
+    }
+    xof.squeeze_blocks(out, 1);
+    for (int l = 0; l < 4; l++){
+      if (results[l]){
+        pos[l] += rejectUniform(*results[l], filled[l], &stream[l][pos[l]],
+                                stream[l].size() - pos[l], range, offset);
+      }
+    }
+  }
+}
+
 /* Samples and returns the public polynomials a1 and a2.
  * Each polynomial is a member of ring group R_q and can be
- * represented as a single number. */
+ * represented as a single number. Both are expanded from publicSeed
+ * (nonces 0 and 1) in one four-way SHAKE128 pass. */
 void RingTesla::genPublic(){
-  a1 = sampleZqPolynomial(false);
-  a2 = sampleZqPolynomial(false);
+  drawSeed(publicSeed);
+  const unsigned char* seeds[4] = {publicSeed, publicSeed, publicSeed, publicSeed};
+  const unsigned int nonces[4] = {0, 1, 0, 0};
+  vector<int>* results[4] = {&a1, &a2, NULL, NULL};
+  sampleZqPolynomialsX4(seeds, nonces, false, results);
 }
 
 /* Returns a polynomial of length n according to the discrete Gaussian distribution with
@@ -151,6 +299,8 @@ vector<int> RingTesla::calculateT(vector<int>& a, vector<int>& s, vector<int>& e
 }
 
 void RingTesla::keyGen(){
+  PHASE_SCOPE("keygen");
+  PHASE_BEGIN(phase);
   vector<int> s;
   vector<int> e1; 
   vector<int> e2;
@@ -159,10 +309,13 @@ void RingTesla::keyGen(){
     e1 = sampleGaussianPolynomial();
     e2 = sampleGaussianPolynomial();
   } while(checkE(e1) || checkE(e2)); /* Continue to sample if polynomials do not pass */
+  drawSeed(ySeed);
+  PHASE_LAP("keygen: sample s, e", phase);
 
   /* Generate the public and private keys */
   vector<int> t1 = calculateT(a1, s, e1);
   vector<int> t2 = calculateT(a2, s, e2);
+  PHASE_LAP("keygen: t = a*s + e", phase);
 
   /* Obtain the public and secret keys */
   sk = make_tuple(s, e1, e2);
@@ -191,28 +344,46 @@ bool RingTesla::checkZ(vector<int>& z_vec){
   return true;
 }
 
-vector<int> RingTesla::encoding(string hashResult){
-  int numIndexBits = (unsigned int)log2(n);
-  int blockSize = kappa / w;
+/* Maps the kappa-bit digest to a polynomial with exactly w entries of +-1.
+ * The digest seeds SHAKE256, whose output supplies w sign bits followed by
+ * as many index candidates as it takes to find w distinct positions. */
+vector<int> RingTesla::encoding(const unsigned char* digest){
+  unsigned int numIndexBits = (unsigned int) ceil(log2(n));
+  unsigned int indexMask = (1U << numIndexBits) - 1;
+  SHAKE xof(SHAKE::SHAKE256_RATE);
+  xof.absorb(digest, kappa / 8);
+
+  vector<unsigned char> signs((w + 7) / 8);
+  xof.squeeze(signs.data(), signs.size());
 
-  /* For each block, encode a single element in result */
   vector<int> result(n);
-  for(unsigned int i = 0; i < w; i++){
-    string blockStr = hashResult.substr(i * (blockSize / 4), blockSize / 4); /* divide by 4 because hexadecimal */
-    unsigned int x;
-    std::stringstream ss;
-    ss << hex << blockStr;
-    ss >> x;
-
-    unsigned int signBitTest = (1 << (blockSize - 1));
-    bool sign = x & signBitTest; // Gets most significant bit
-    unsigned int index = (x & (~signBitTest)) >> (blockSize - numIndexBits);
+  for (unsigned int i = 0; i < w; ){
+    unsigned char x[2];
+    xof.squeeze(x, 2);
+    unsigned int index = (x[0] | (x[1] << 8)) & indexMask;
+    if (index >= n || result[index] != 0){
+      continue;
+    }
+    bool sign = (signs[i >> 3] >> (i & 7)) & 1;
     result[index] = sign ? 1 : -1;
+    i++;
   }
   return result;
 }
 
-string RingTesla::hash(string message, vector<int>& v1, vector<int>& v2){
+/* The message as it enters the challenge hash and the y derivation: the
+ * message itself, or in tree mode its tree root, stored in root */
+string& RingTesla::representative(string& message, string& root){
+  if (prehash != SHA256_PREHASH_TREE){
+    return message;
+  }
+  root.resize(SHA256::DIGEST_SIZE);
+  sha256_tree((const uint8_t*) message.data(), message.size(), (uint8_t*) &root[0]);
+  return root;
+}
+
+/* Message followed by the high bits of v1 and v2, as fed to the hash */
+string RingTesla::hashInput(string& message, vector<int>& v1, vector<int>& v2){
   string toHash = message;
   for (unsigned int i = 0; i < v1.size(); i++){
 	  toHash += to_string(v1[i]>> d);
@@ -220,66 +391,247 @@ string RingTesla::hash(string message, vector<int>& v1, vector<int>& v2){
   for (unsigned int i = 0; i < v2.size(); i++){
 	  toHash += to_string(v2[i]>> d);
   }
-  string hashResult = sha256(toHash);
-  return hashResult;
+  return toHash;
+}
+
+/* Writes the SHA256::DIGEST_SIZE byte digest to digest */
+void RingTesla::hash(string& message, vector<int>& v1, vector<int>& v2, unsigned char* digest){
+  string toHash = hashInput(message, v1, v2);
+  sha256_digest((const uint8_t*) toHash.data(), toHash.size(), digest);
+}
+
+/* Hashes every input with the multi-buffer SHA-256 engine. Digest i is
+ * written to digests + i * SHA256::DIGEST_SIZE. */
+void RingTesla::hashBatch(vector<string>& inputs, unsigned char* digests){
+  vector<const unsigned char*> ptrs(inputs.size());
+  vector<size_t> lengths(inputs.size());
+  for (unsigned int i = 0; i < inputs.size(); i++){
+    ptrs[i] = (const unsigned char*) inputs[i].data();
+    lengths[i] = inputs[i].size();
+  }
+  sha256_batch(ptrs.data(), lengths.data(), digests, inputs.size());
 }
 
 /* Signs a message with the secret key. The result is stored in c_prime and z */
-tuple<vector<int>, string> RingTesla::sign(string message){
+tuple<vector<int>, string> RingTesla::sign(string message, unsigned int* attempts){
+  PHASE_SCOPE("sign");
+  PHASE_BEGIN(phase);
   vector<int> w1;
   vector<int> w2;
   vector<int> z;
-  string c_prime;
+  unsigned char digest[SHA256::DIGEST_SIZE];
+  unsigned char rhoPrime[seedBytes];
+  string root;
+  string& mu = representative(message, root);
+  deriveYSeed(mu, rhoPrime);
+  unsigned int attempt = 0;
+  bool accepted;
+  PHASE_LAP("sign: derive y seed", phase);
 
   do{
+    PHASE_BEGIN(attemptStart);
     /* Sample y uniformly from R_{q, {B}} */
-    vector<int> y = sampleZqPolynomial(true);
+    vector<int> y = sampleZqPolynomial(rhoPrime, attempt++, true);
+    PHASE_LAP("sign: sample y", phase);
 
     /* Calculate v1 and v2 */
     vector<int> v1 = multiplyPolynomials(a1, y);
-    performModQ(v1);
     vector<int> v2 = multiplyPolynomials(a2, y);
+    PHASE_LAP("sign: a*y", phase);
+    performModQ(v1);
     performModQ(v2);
+    PHASE_LAP("sign: reduce", phase);
 
-    c_prime = hash(message, v1, v2);
-    vector<int> c = encoding(c_prime);
+    hash(mu, v1, v2, digest);
+    PHASE_LAP("sign: hash", phase);
+    vector<int> c = encoding(digest);
+    PHASE_LAP("sign: encoding", phase);
 
-    /* Calculate z */
+    /* z = y + s*c; w = v - e*c for rejection sampling */
     vector<int> s_c = multiplyPolynomials(get<0>(sk), c);
-    z = addPolynomials(y, s_c);
-    /* Rejection Sampling */
     vector<int> e1_c = multiplyPolynomials(get<1>(sk), c);
-    w1 = subtractPolynomials(v1, e1_c);
-    performModQ(w1);
     vector<int> e2_c = multiplyPolynomials(get<2>(sk), c);
+    PHASE_LAP("sign: s*c, e*c", phase);
+    z = addPolynomials(y, s_c);
+    w1 = subtractPolynomials(v1, e1_c);
     w2 = subtractPolynomials(v2, e2_c);
+    PHASE_LAP("sign: add/subtract", phase);
+    performModQ(w1);
     performModQ(w2);
-//    cout << checkW(w1) << checkW(w2) << checkZ(z) << endl;
-  }while (!checkW(w1) || !checkW(w2) || !checkZ(z));
+    PHASE_LAP("sign: reduce", phase);
+
+    accepted = checkW(w1) && checkW(w2) && checkZ(z);
+    PHASE_LAP("sign: checks", phase);
+    PHASE_ATTEMPT("sign attempt", attempt, attemptStart);
+  }while (!accepted);
+  if (attempts){
+    *attempts = attempt;
+  }
+  /* Only the accepted attempt's challenge is needed as text */
+  string c_prime = sha256_hex(digest);
 //  cout << "sign:\t" << c_prime << endl;
   return make_tuple(z, c_prime);
 }
 
 /* Verify */
 bool RingTesla::verify(string message, vector<int>& z, string c_prime){
-  vector<int> c = encoding(c_prime);
+  PHASE_SCOPE("verify");
+  PHASE_BEGIN(phase);
+  unsigned char digest[SHA256::DIGEST_SIZE];
+  if (!sha256_from_hex(c_prime, digest)){
+    return false;
+  }
+  vector<int> c = encoding(digest);
+  PHASE_LAP("verify: encoding", phase);
 
   /* Calculate w1 and w2 */
   vector<int> a1_z = multiplyPolynomials(a1, z);
-  vector<int> t1_c = multiplyPolynomials(get<0>(pk), c);
-  vector<int> w1 = subtractPolynomials(a1_z, t1_c);
-  performModQ(w1);
-
   vector<int> a2_z = multiplyPolynomials(a2, z);
+  PHASE_LAP("verify: a*z", phase);
+  vector<int> t1_c = multiplyPolynomials(get<0>(pk), c);
   vector<int> t2_c = multiplyPolynomials(get<1>(pk), c);
+  PHASE_LAP("verify: t*c", phase);
+  vector<int> w1 = subtractPolynomials(a1_z, t1_c);
   vector<int> w2 = subtractPolynomials(a2_z, t2_c);
+  PHASE_LAP("verify: subtract", phase);
+  performModQ(w1);
   performModQ(w2);
+  PHASE_LAP("verify: reduce", phase);
 
   /* Calculate c_verify */
-  string c_verify = hash(message, w1, w2);
-//  cout << "verify:\t" << c_verify << endl;
-  return (c_prime.compare(c_verify) == 0) && checkZ(z);
+  unsigned char c_verify[SHA256::DIGEST_SIZE];
+  string root;
+  hash(representative(message, root), w1, w2, c_verify);
+  PHASE_LAP("verify: hash", phase);
+  bool valid = (memcmp(digest, c_verify, SHA256::DIGEST_SIZE) == 0) && checkZ(z);
+  PHASE_LAP("verify: checks", phase);
+  return valid;
 }
 
+/* Signs every message, batchSize messages at a time. Each round derives the
+ * next y for every message of the chunk that is still pending and hashes all
+ * of them together; messages whose attempt is rejected are retried in the
+ * next round. Signatures match those of sign(). */
+vector<tuple<vector<int>, string> > RingTesla::signBatch(vector<string>& messages){
+  PHASE_SCOPE("sign_batch");
+  vector<tuple<vector<int>, string> > signatures(messages.size());
+  for (unsigned int start = 0; start < messages.size(); start += batchSize){
+    vector<unsigned int> pending(min<size_t>(batchSize, messages.size() - start));
+    iota(pending.begin(), pending.end(), start);
+    signChunk(messages, pending, signatures);
+  }
+  return signatures;
+}
+
+void RingTesla::signChunk(vector<string>& messages, vector<unsigned int>& pending,
+                          vector<tuple<vector<int>, string> >& signatures){
+  /* pending starts as a contiguous run of message indices */
+  unsigned int base = pending.front();
+  vector<unsigned char> rhoPrimes(pending.size() * seedBytes);
+  vector<unsigned int> attempts(pending.size(), 0);
+  vector<string> roots(pending.size());
+  vector<string*> mus(pending.size());
+  for (unsigned int k = 0; k < pending.size(); k++){
+    mus[k] = &representative(messages[pending[k]], roots[k]);
+    deriveYSeed(*mus[k], &rhoPrimes[k * seedBytes]);
+  }
 
+  while (!pending.empty()){
+    vector<vector<int> > v1s(pending.size());
+    vector<vector<int> > v2s(pending.size());
+    vector<vector<int> > ys(pending.size());
+    vector<string> inputs(pending.size());
+    /* y for four pending messages per four-way SHAKE256 pass */
+    for (unsigned int k = 0; k < pending.size(); k += 4){
+      const unsigned char* seeds[4];
+      unsigned int nonces[4];
+      vector<int>* results[4];
+      for (unsigned int l = 0; l < 4; l++){
+        unsigned int slot = pending[min<size_t>(k + l, pending.size() - 1)] - base;
+        seeds[l] = &rhoPrimes[slot * seedBytes];
+        nonces[l] = attempts[slot];
+        results[l] = k + l < pending.size() ? &ys[k + l] : NULL;
+      }
+      sampleZqPolynomialsX4(seeds, nonces, true, results);
+    }
+    for (unsigned int k = 0; k < pending.size(); k++){
+      attempts[pending[k] - base]++;
+      v1s[k] = multiplyPolynomials(a1, ys[k]);
+      performModQ(v1s[k]);
+      v2s[k] = multiplyPolynomials(a2, ys[k]);
+      performModQ(v2s[k]);
+      inputs[k] = hashInput(*mus[pending[k] - base], v1s[k], v2s[k]);
+    }
+    vector<unsigned char> digests(pending.size() * SHA256::DIGEST_SIZE);
+    hashBatch(inputs, digests.data());
+
+    vector<unsigned int> rejected;
+    for (unsigned int k = 0; k < pending.size(); k++){
+      unsigned char* digest = &digests[k * SHA256::DIGEST_SIZE];
+      vector<int> c = encoding(digest);
+      vector<int> s_c = multiplyPolynomials(get<0>(sk), c);
+      vector<int> z = addPolynomials(ys[k], s_c);
+      vector<int> e1_c = multiplyPolynomials(get<1>(sk), c);
+      vector<int> w1 = subtractPolynomials(v1s[k], e1_c);
+      performModQ(w1);
+      vector<int> e2_c = multiplyPolynomials(get<2>(sk), c);
+      vector<int> w2 = subtractPolynomials(v2s[k], e2_c);
+      performModQ(w2);
+      if (checkW(w1) && checkW(w2) && checkZ(z)){
+        signatures[pending[k]] = make_tuple(z, sha256_hex(digest));
+      } else {
+        rejected.push_back(pending[k]);
+      }
+    }
+    pending.swap(rejected);
+  }
+}
+
+vector<bool> RingTesla::verifyBatch(vector<string>& messages,
+                                    vector<tuple<vector<int>, string> >& signatures){
+  PHASE_SCOPE("verify_batch");
+  vector<bool> results(messages.size());
+  for (unsigned int start = 0; start < messages.size(); start += batchSize){
+    unsigned int end = min<size_t>(start + batchSize, messages.size());
+    verifyChunk(messages, signatures, start, end, results);
+  }
+  return results;
+}
 
+void RingTesla::verifyChunk(vector<string>& messages,
+                            vector<tuple<vector<int>, string> >& signatures,
+                            unsigned int start, unsigned int end, vector<bool>& results){
+  vector<string> inputs(end - start);
+  vector<unsigned char> c_primes((end - start) * SHA256::DIGEST_SIZE);
+  for (unsigned int i = start; i < end; i++){
+    unsigned char* c_prime = &c_primes[(i - start) * SHA256::DIGEST_SIZE];
+    results[i] = sha256_from_hex(get<1>(signatures[i]), c_prime);
+    if (!results[i]){
+      continue; /* malformed challenge; its empty input is hashed but ignored */
+    }
+    vector<int>& z = get<0>(signatures[i]);
+    vector<int> c = encoding(c_prime);
+
+    vector<int> a1_z = multiplyPolynomials(a1, z);
+    vector<int> t1_c = multiplyPolynomials(get<0>(pk), c);
+    vector<int> w1 = subtractPolynomials(a1_z, t1_c);
+    performModQ(w1);
+
+    vector<int> a2_z = multiplyPolynomials(a2, z);
+    vector<int> t2_c = multiplyPolynomials(get<1>(pk), c);
+    vector<int> w2 = subtractPolynomials(a2_z, t2_c);
+    performModQ(w2);
+
+    string root;
+    inputs[i - start] = hashInput(representative(messages[i], root), w1, w2);
+  }
+  vector<unsigned char> c_verify((end - start) * SHA256::DIGEST_SIZE);
+  hashBatch(inputs, c_verify.data());
+
+  for (unsigned int i = start; i < end; i++){
+    unsigned int offset = (i - start) * SHA256::DIGEST_SIZE;
+    results[i] = results[i] &&
+                 (memcmp(&c_primes[offset], &c_verify[offset], SHA256::DIGEST_SIZE) == 0) &&
+                 checkZ(get<0>(signatures[i]));
+  }
+}
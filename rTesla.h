@@ -6,10 +6,12 @@
 #include <random>
 #include <chrono>
 #include <vector>
+#include "sha256.h"
 
 using namespace std;
 
 class RingTesla {
+  friend class Microbench; /* times the private kernels in isolation */
 private:
   unsigned int n; // Encoding function: output vector length (must be positive)
   unsigned int w; // Encoding function: weight
@@ -22,22 +24,36 @@ private:
   unsigned int lambda; // Security parameter, which is < kappa < length
   unsigned int kappa; // Output length of hash function
   double q_inv;
+  static const unsigned int batchSize = 256; /* Messages per chunk in signBatch and verifyBatch */
+  static const unsigned int seedBytes = 32; /* SHAKE seeds for a1/a2 and y */
 
-  /* Random Number Generator */
+  /* SEQUENTIAL hashes the message itself along with v1 and v2; TREE first
+   * reduces it to its sha256_tree() root so huge messages hash in parallel */
+  Sha256Prehash prehash;
+
+  /* Random Number Generator, seeded from the clock unless setSeed() is called */
   /* TODO: Is not necessarily cryptographically secure */
-  unsigned timeSeed = chrono::system_clock::now().time_since_epoch().count();
+  unsigned seed = chrono::system_clock::now().time_since_epoch().count();
   default_random_engine generator;
 
   /* Public polynomials */
   vector<int> a1;
   vector<int> a2; 
+  unsigned char publicSeed[seedBytes]; /* a1 and a2 are expanded from this */
+
+  /* Secret seed from which y is derived per message and attempt */
+  unsigned char ySeed[seedBytes];
 
   /* Keys */
   tuple<vector<int>, vector<int>, vector<int> > sk; /* (s, e1, e2) */
   tuple<vector<int>, vector<int> > pk; /* (t1, t2) */
 
   /* Methods */ 
-  vector<int> sampleZqPolynomial(bool useB);
+  void drawSeed(unsigned char* seed);
+  void deriveYSeed(string& message, unsigned char* rhoPrime);
+  vector<int> sampleZqPolynomial(const unsigned char* seed, unsigned int nonce, bool useB);
+  void sampleZqPolynomialsX4(const unsigned char* const seeds[4], const unsigned int nonces[4],
+                             bool useB, vector<int>* results[4]);
   vector<int> sampleGaussianPolynomial();
   bool checkE(vector<int>& e); /* for keygen */
   bool checkW(vector<int>& w); /* for signing */
@@ -50,11 +66,19 @@ private:
   vector<int> subtractPolynomials(vector<int>& vec1, vector<int>& vec2); 
   vector<int> addPolynomials(vector<int>& vec1, vector<int>& vec2); 
   vector<int> calculateT(vector<int>& a, vector<int>& s, vector<int>& e);
-  string hash(string message, vector<int>& v1, vector<int>& v2);
-  vector<int> encoding(string hashResult);
+  string& representative(string& message, string& root);
+  string hashInput(string& message, vector<int>& v1, vector<int>& v2);
+  void hash(string& message, vector<int>& v1, vector<int>& v2, unsigned char* digest);
+  void hashBatch(vector<string>& inputs, unsigned char* digests);
+  vector<int> encoding(const unsigned char* digest);
+  void signChunk(vector<string>& messages, vector<unsigned int>& pending,
+                 vector<tuple<vector<int>, string> >& signatures);
+  void verifyChunk(vector<string>& messages, vector<tuple<vector<int>, string> >& signatures,
+                   unsigned int start, unsigned int end, vector<bool>& results);
 
 public:
-  RingTesla();
+  enum ParameterSet { RING_TESLA_I, RING_TESLA_II };
+  RingTesla(ParameterSet set = RING_TESLA_I);
   void genPublic();
   vector<int> getA1(){return a1;}
   vector<int> getA2(){return a2;}
@@ -62,8 +86,31 @@ public:
   void keyGen();
   tuple<vector<int>, vector<int> > getPK(){return pk;} /* Public key is accessible */
 
-  tuple<vector<int>, string> sign(string message);
+  /* Serialized sizes in bytes, with coefficients packed at the bit width of
+   * their range */
+  unsigned int publicKeySize();
+  unsigned int secretKeySize();
+  unsigned int signatureSize();
+
+  void setPrehash(Sha256Prehash mode){prehash = mode;}
+  Sha256Prehash getPrehash(){return prehash;}
+
+  /* Restarts the generator behind genPublic() and keyGen(). With the same
+   * seed they produce the same a1, a2 and keys, and since y is derived from
+   * the key and message, sign() then repeats the same draws and rejections;
+   * for benchmarking on identical work, not for real keys */
+  void setSeed(unsigned value){seed = value; generator.seed(seed);}
+  unsigned getSeed(){return seed;}
+
+  /* attempts, if given, receives the number of rejection-sampling rounds */
+  tuple<vector<int>, string> sign(string message, unsigned int* attempts = NULL);
   bool verify(string message, vector<int>& z, string c_prime);
+
+  /* Batched variants: the hashes of all messages in a batch are computed
+   * together with sha256_batch() */
+  vector<tuple<vector<int>, string> > signBatch(vector<string>& messages);
+  vector<bool> verifyBatch(vector<string>& messages,
+                           vector<tuple<vector<int>, string> >& signatures);
 };
 
 #endif
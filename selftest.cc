@@ -0,0 +1,304 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "sha256.h"
+#include "keccak.h"
+
+using namespace std;
+
+/* Known-answer and cross checks of the hand-written SIMD code paths, run by
+ * make check. Every SIMD result is compared with a published vector or with
+ * the generic code; exits nonzero if any check fails. */
+
+static unsigned int failures = 0;
+
+static void check(bool ok, const string& what){
+  if (!ok){
+    cerr << "FAIL: " << what << endl;
+    failures++;
+  }
+}
+
+/* FIPS 180-2 appendix B vectors and the empty message */
+struct Sha256Vector {
+  string message;
+  unsigned int repeat;
+  const char *digest;
+};
+
+static const Sha256Vector sha256Vectors[] = {
+  {"", 1, "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855"},
+  {"abc", 1, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad"},
+  {"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+   "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1"},
+  {"abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopq"
+   "klmnopqrlmnopqrsmnopqrstnopqrstu", 1,
+   "cf5b16a778af8380036ce59e7b0492370b249b11e8f07a51afac45037afee9d1"},
+  {"a", 1000000, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0"},
+};
+
+/* Random messages of every length up to a few blocks past the padding
+ * boundaries, plus some long ones */
+static vector<vector<uint8_t> > randomMessages(){
+  mt19937 generator(2024);
+  vector<vector<uint8_t> > messages;
+  for (unsigned int len = 0; len <= 200; len++){
+    messages.push_back(vector<uint8_t>(len));
+  }
+  messages.push_back(vector<uint8_t>(4096));
+  messages.push_back(vector<uint8_t>(100003));
+  for (unsigned int i = 0; i < messages.size(); i++){
+    for (unsigned int j = 0; j < messages[i].size(); j++){
+      messages[i][j] = (uint8_t) generator();
+    }
+  }
+  return messages;
+}
+
+/* Hashes message through update() in uneven pieces, so block transforms see
+ * both buffered and direct input */
+static string digestInPieces(const vector<uint8_t>& message){
+  SHA256 ctx;
+  unsigned char digest[SHA256::DIGEST_SIZE];
+  size_t pos = 0;
+  for (size_t piece = 1; pos < message.size(); piece = piece * 3 + 1){
+    size_t len = min(piece, message.size() - pos);
+    ctx.update(&message[pos], len);
+    pos += len;
+  }
+  ctx.final(digest);
+  return sha256_hex(digest);
+}
+
+/* Every block transform that set_backend() accepts on this CPU */
+static void checkSha256Backends(){
+  const SHA256::Backend backends[] = {SHA256::BACKEND_GENERIC, SHA256::BACKEND_AVX2,
+                                      SHA256::BACKEND_SHANI};
+  SHA256::Backend original = SHA256::backend();
+  vector<vector<uint8_t> > messages = randomMessages();
+
+  SHA256::set_backend(SHA256::BACKEND_GENERIC);
+  vector<string> expected(messages.size());
+  for (unsigned int i = 0; i < messages.size(); i++){
+    unsigned char digest[SHA256::DIGEST_SIZE];
+    sha256_digest(messages[i].data(), messages[i].size(), digest);
+    expected[i] = sha256_hex(digest);
+  }
+
+  for (unsigned int b = 0; b < sizeof(backends) / sizeof(backends[0]); b++){
+    string name = SHA256::backend_name(backends[b]);
+    if (!SHA256::set_backend(backends[b])){
+      cout << "sha256 " << name << ": not supported on this CPU, skipped" << endl;
+      continue;
+    }
+    for (unsigned int v = 0; v < sizeof(sha256Vectors) / sizeof(sha256Vectors[0]); v++){
+      const Sha256Vector& kat = sha256Vectors[v];
+      string message;
+      for (unsigned int r = 0; r < kat.repeat; r++){
+        message += kat.message;
+      }
+      check(sha256(message) == kat.digest,
+            "sha256 " + name + " FIPS 180 vector " + to_string(v));
+    }
+    for (unsigned int i = 0; i < messages.size(); i++){
+      unsigned char digest[SHA256::DIGEST_SIZE];
+      sha256_digest(messages[i].data(), messages[i].size(), digest);
+      check(sha256_hex(digest) == expected[i],
+            "sha256 " + name + " length " + to_string(messages[i].size()));
+      check(digestInPieces(messages[i]) == expected[i],
+            "sha256 " + name + " length " + to_string(messages[i].size()) + " in pieces");
+    }
+    cout << "sha256 " << name << ": checked" << endl;
+  }
+  SHA256::set_backend(original);
+}
+
+/* sha256_batch() at every lane width the CPU supports, for every count up to
+ * one past a full 16-lane group. Lengths differ within each call, so lanes
+ * finish at different blocks, and some are empty or end right at a padding
+ * boundary. */
+static void checkSha256Batch(){
+  const unsigned int widths[] = {1, 4, 8, 16};
+  const size_t lengths[] = {0, 1, 55, 56, 63, 64, 65, 119, 120, 200, 1000, 3, 128, 511, 64, 9, 77};
+  const unsigned int maxCount = sizeof(lengths) / sizeof(lengths[0]);
+  unsigned int original = SHA256::batch_lanes();
+  mt19937 generator(17);
+
+  for (unsigned int w = 0; w < sizeof(widths) / sizeof(widths[0]); w++){
+    if (!SHA256::set_batch_lanes(widths[w])){
+      cout << "sha256_batch " << widths[w] << " lanes: not supported on this CPU, skipped" << endl;
+      continue;
+    }
+    for (unsigned int count = 1; count <= maxCount; count++){
+      vector<vector<uint8_t> > messages(count);
+      vector<const unsigned char *> pointers(count);
+      vector<size_t> sizes(count);
+      for (unsigned int i = 0; i < count; i++){
+        /* Rotate the lengths so every lane sees short and long messages */
+        messages[i].resize(lengths[(i + count) % maxCount]);
+        for (unsigned int j = 0; j < messages[i].size(); j++){
+          messages[i][j] = (uint8_t) generator();
+        }
+        pointers[i] = messages[i].data();
+        sizes[i] = messages[i].size();
+      }
+      vector<unsigned char> digests(count * SHA256::DIGEST_SIZE);
+      sha256_batch(pointers.data(), sizes.data(), digests.data(), count);
+      for (unsigned int i = 0; i < count; i++){
+        unsigned char expected[SHA256::DIGEST_SIZE];
+        sha256_digest(messages[i].data(), messages[i].size(), expected);
+        check(sha256_hex(&digests[i * SHA256::DIGEST_SIZE]) == sha256_hex(expected),
+              "sha256_batch " + to_string(widths[w]) + " lanes, message " + to_string(i) +
+              " of " + to_string(count) + " (" + to_string(sizes[i]) + " bytes)");
+      }
+    }
+    cout << "sha256_batch " << widths[w] << " lanes: checked" << endl;
+  }
+  SHA256::set_batch_lanes(original);
+}
+
+/* NIST SHAKE examples: the first 32 and the last 32 of 512 output bytes, so
+ * the squeeze runs over several blocks, for the empty message and for 200
+ * bytes of 0xa3 (more than one SHAKE256 block to absorb) */
+struct ShakeVector {
+  unsigned int rate;
+  size_t length;
+  const char *first;
+  const char *last;
+};
+
+static const ShakeVector shakeVectors[] = {
+  {SHAKE::SHAKE128_RATE, 0,
+   "7f9c2ba4e88f827d616045507605853ed73b8093f6efbc88eb1a6eacfa66ef26",
+   "43e41b45a653f2a5c4492c1add544512dda2529833462b71a41a45be97290b6f"},
+  {SHAKE::SHAKE128_RATE, 200,
+   "131ab8d2b594946b9c81333f9bb6e0ce75c3b93104fa3469d3917457385da037",
+   "44c9fb359fd56ac0a9a75a743cff6862f17d7259ab075216c0699511643b6439"},
+  {SHAKE::SHAKE256_RATE, 0,
+   "46b9dd2b0ba88d13233b3feb743eeb243fcd52ea62b81b82b50c27646ed5762f",
+   "ab0bae316339894304e35877b0c28a9b1fd166c796b9cc258a064a8f57e27f2a"},
+  {SHAKE::SHAKE256_RATE, 200,
+   "cd8a920ed141aa0407a22d59288652e9d9f1a7ee0c1e7c1ca699424da84a904d",
+   "6a1a9d7846436e4dca5728b6f760eef0ca92bf0be5615e96959d767197a0beeb"},
+};
+
+static string hex(const uint8_t *data, size_t len){
+  static const char digits[] = "0123456789abcdef";
+  string result;
+  for (size_t i = 0; i < len; i++){
+    result += digits[data[i] >> 4];
+    result += digits[data[i] & 15];
+  }
+  return result;
+}
+
+static bool matchesShakeVector(const uint8_t *out, const ShakeVector& kat){
+  return hex(out, 32) == kat.first && hex(out + 512 - 32, 32) == kat.last;
+}
+
+/* SHAKE one state at a time, SHAKEx4 four at a time (keccak_f1600_x4(),
+ * AVX2 where the CPU has it), and the two permutations against each other */
+static void checkKeccak(){
+  const size_t outputBytes = 512;
+  mt19937 generator(30);
+
+  for (unsigned int v = 0; v < sizeof(shakeVectors) / sizeof(shakeVectors[0]); v++){
+    const ShakeVector& kat = shakeVectors[v];
+    string name = "SHAKE" + to_string(kat.rate == SHAKE::SHAKE128_RATE ? 128 : 256) +
+                  " " + to_string(kat.length) + "-byte vector";
+    vector<uint8_t> message(kat.length, 0xa3);
+
+    /* One squeeze, then the same stream in uneven pieces */
+    vector<uint8_t> out(outputBytes);
+    SHAKE shake(kat.rate);
+    shake.absorb(message.data(), message.size());
+    shake.squeeze(out.data(), out.size());
+    check(matchesShakeVector(out.data(), kat), name);
+    shake.init(kat.rate);
+    shake.absorb(message.data(), message.size());
+    for (size_t pos = 0, piece = 1; pos < outputBytes; pos += piece, piece = piece * 2 + 1){
+      shake.squeeze(&out[pos], min(piece, outputBytes - pos));
+    }
+    check(matchesShakeVector(out.data(), kat), name + " in pieces");
+
+    /* All four lanes of SHAKEx4 hash the vector */
+    size_t blocks = (outputBytes + kat.rate - 1) / kat.rate;
+    vector<uint8_t> lanes[4];
+    const uint8_t *in[4];
+    uint8_t *outs[4];
+    for (int j = 0; j < 4; j++){
+      lanes[j].resize(blocks * kat.rate);
+      in[j] = message.data();
+      outs[j] = lanes[j].data();
+    }
+    SHAKEx4 shakes(kat.rate, in, message.size());
+    shakes.squeeze_blocks(outs, blocks);
+    for (int j = 0; j < 4; j++){
+      check(matchesShakeVector(lanes[j].data(), kat), name + " x4 lane " + to_string(j));
+    }
+  }
+
+  /* Four different inputs of each length through SHAKEx4 against SHAKE */
+  const unsigned int rates[] = {SHAKE::SHAKE128_RATE, SHAKE::SHAKE256_RATE};
+  for (unsigned int r = 0; r < 2; r++){
+    for (size_t len = 0; len <= 400; len += 37){
+      vector<uint8_t> messages[4], lanes[4];
+      const uint8_t *in[4];
+      uint8_t *outs[4];
+      for (int j = 0; j < 4; j++){
+        messages[j].resize(len);
+        for (size_t i = 0; i < len; i++){
+          messages[j][i] = (uint8_t) generator();
+        }
+        lanes[j].resize(3 * rates[r]);
+        in[j] = messages[j].data();
+        outs[j] = lanes[j].data();
+      }
+      SHAKEx4 shakes(rates[r], in, len);
+      shakes.squeeze_blocks(outs, 3);
+      for (int j = 0; j < 4; j++){
+        vector<uint8_t> expected(3 * rates[r]);
+        SHAKE shake(rates[r]);
+        shake.absorb(messages[j].data(), len);
+        shake.squeeze(expected.data(), expected.size());
+        check(lanes[j] == expected, "SHAKEx4 rate " + to_string(rates[r]) + ", " +
+              to_string(len) + " bytes, lane " + to_string(j));
+      }
+    }
+  }
+
+  /* keccak_f1600_x4() on random states, against keccak_f1600() lane by lane */
+  for (int round = 0; round < 16; round++){
+    uint64_t states[4 * 25];
+    uint64_t state[4][25];
+    for (int i = 0; i < 25; i++){
+      for (int j = 0; j < 4; j++){
+        state[j][i] = ((uint64_t) generator() << 32) | generator();
+        states[4 * i + j] = state[j][i];
+      }
+    }
+    keccak_f1600_x4(states);
+    bool same = true;
+    for (int j = 0; j < 4; j++){
+      keccak_f1600(state[j]);
+      for (int i = 0; i < 25; i++){
+        same = same && states[4 * i + j] == state[j][i];
+      }
+    }
+    check(same, "keccak_f1600_x4 random states " + to_string(round));
+  }
+  cout << "keccak: checked" << endl;
+}
+
+int main(){
+  checkSha256Backends();
+  checkSha256Batch();
+  checkKeccak();
+  if (failures){
+    cerr << failures << " checks failed" << endl;
+    return 1;
+  }
+  cout << "all checks passed" << endl;
+  return 0;
+}
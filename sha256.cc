@@ -1,6 +1,21 @@
 #include <cstring>
 #include <fstream>
 #include "sha256.h"
+#if SHA256_HAVE_X86
+#include <cpuid.h>
+#endif
+ 
+#if defined(__unix__) || defined(__unix) || (defined(__APPLE__) && defined(__MACH__))
+#define SHA256_HAVE_POSIX 1
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define SHA256_HAVE_POSIX 0
+#endif
  
 const unsigned int SHA256::sha256_k[64] = //UL = uint32
             {0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
@@ -20,15 +35,194 @@ const unsigned int SHA256::sha256_k[64] = //UL = uint32
              0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
              0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
  
-void SHA256::transform(const unsigned char *message, unsigned int block_nb)
+SHA256::Backend SHA256::s_backend = SHA256::detect_backend();
+SHA256::transform_fn SHA256::s_transform = SHA256::backend_transform(SHA256::s_backend);
+unsigned int SHA256::s_batch_lanes = SHA256::detect_batch_lanes();
+ 
+#if SHA256_HAVE_X86
+/* AVX2 needs both the CPUID bit and the OS saving YMM state (XCR0 bits 1-2) */
+static bool cpu_has_avx2_bmi2()
+{
+    unsigned int eax, ebx, ecx, edx, xcr0_lo, xcr0_hi;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    if (!(ecx & bit_OSXSAVE) || !(ecx & bit_AVX))
+        return false;
+    __asm__ ("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 0x6) != 0x6)
+        return false;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+    return (ebx & bit_AVX2) && (ebx & bit_BMI2);
+}
+ 
+/* AVX-512F additionally needs the opmask and ZMM state (XCR0 bits 5-7) */
+static bool cpu_has_avx512f()
+{
+    unsigned int eax, ebx, ecx, edx, xcr0_lo, xcr0_hi;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    if (!(ecx & bit_OSXSAVE))
+        return false;
+    __asm__ ("xgetbv" : "=a"(xcr0_lo), "=d"(xcr0_hi) : "c"(0));
+    if ((xcr0_lo & 0xe6) != 0xe6)
+        return false;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+    return ebx & bit_AVX512F;
+}
+ 
+static bool cpu_has_shani()
+{
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+    if (!(ecx & bit_SSSE3) || !(ecx & bit_SSE4_1))
+        return false;
+    if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+    return ebx & bit_SHA;
+}
+#endif
+ 
+bool SHA256::backend_supported(Backend b)
+{
+    switch (b) {
+    case BACKEND_GENERIC:
+        return true;
+#if SHA256_HAVE_X86
+    case BACKEND_AVX2:
+        return cpu_has_avx2_bmi2();
+    case BACKEND_SHANI:
+        return cpu_has_shani();
+#endif
+    default:
+        return false;
+    }
+}
+ 
+SHA256::Backend SHA256::detect_backend()
+{
+    if (backend_supported(BACKEND_SHANI))
+        return BACKEND_SHANI;
+    if (backend_supported(BACKEND_AVX2))
+        return BACKEND_AVX2;
+    return BACKEND_GENERIC;
+}
+ 
+SHA256::transform_fn SHA256::backend_transform(Backend b)
+{
+    switch (b) {
+#if SHA256_HAVE_X86
+    case BACKEND_AVX2:
+        return &transform_avx2;
+    case BACKEND_SHANI:
+        return &transform_shani;
+#endif
+    default:
+        return &transform_generic;
+    }
+}
+ 
+SHA256::Backend SHA256::backend()
+{
+    return s_backend;
+}
+ 
+/* Returns false (and keeps the current backend) if b is not supported here */
+bool SHA256::set_backend(Backend b)
+{
+    if (!backend_supported(b))
+        return false;
+    s_backend = b;
+    s_transform = backend_transform(b);
+    return true;
+}
+ 
+const char *SHA256::backend_name(Backend b)
+{
+    switch (b) {
+    case BACKEND_AVX2:
+        return "avx2";
+    case BACKEND_SHANI:
+        return "sha-ni";
+    default:
+        return "generic";
+    }
+}
+ 
+bool SHA256::batch_lanes_supported(unsigned int lanes)
+{
+    switch (lanes) {
+    case 1:
+        return true;
+#if SHA256_HAVE_X86
+    case 4:
+        return true;
+    case 8:
+        return cpu_has_avx2_bmi2();
+    case 16:
+        return cpu_has_avx512f();
+#endif
+    default:
+        return false;
+    }
+}
+ 
+/* SHA-NI hashing one message at a time keeps up with 8 AVX2 lanes and beats
+ * 4 SSE2 lanes, so only AVX-512 is preferred over it. */
+unsigned int SHA256::detect_batch_lanes()
+{
+    if (batch_lanes_supported(16))
+        return 16;
+    if (backend_supported(BACKEND_SHANI))
+        return 1;
+    if (batch_lanes_supported(8))
+        return 8;
+    if (batch_lanes_supported(4))
+        return 4;
+    return 1;
+}
+ 
+/* Returns 0 for lanes == 1: sha256_batch() then hashes messages in turn */
+SHA256::transform_mb_fn SHA256::batch_transform(unsigned int lanes)
+{
+    switch (lanes) {
+#if SHA256_HAVE_X86
+    case 4:
+        return &transform_mb4;
+    case 8:
+        return &transform_mb8;
+    case 16:
+        return &transform_mb16;
+#endif
+    default:
+        return 0;
+    }
+}
+ 
+unsigned int SHA256::batch_lanes()
+{
+    return s_batch_lanes;
+}
+ 
+bool SHA256::set_batch_lanes(unsigned int lanes)
+{
+    if (!batch_lanes_supported(lanes))
+        return false;
+    s_batch_lanes = lanes;
+    return true;
+}
+ 
+void SHA256::transform_generic(uint32 *h, const unsigned char *message, size_t block_nb)
 {
     uint32 w[64];
     uint32 wv[8];
     uint32 t1, t2;
     const unsigned char *sub_block;
-    int i;
+    size_t i;
     int j;
-    for (i = 0; i < (int) block_nb; i++) {
+    for (i = 0; i < block_nb; i++) {
         sub_block = message + (i << 6);
         for (j = 0; j < 16; j++) {
             SHA2_PACK32(&sub_block[j << 2], &w[j]);
@@ -37,7 +231,7 @@ void SHA256::transform(const unsigned char *message, unsigned int block_nb)
             w[j] =  SHA256_F4(w[j -  2]) + w[j -  7] + SHA256_F3(w[j - 15]) + w[j - 16];
         }
         for (j = 0; j < 8; j++) {
-            wv[j] = m_h[j];
+            wv[j] = h[j];
         }
         for (j = 0; j < 64; j++) {
             t1 = wv[7] + SHA256_F2(wv[4]) + SHA2_CH(wv[4], wv[5], wv[6])
@@ -53,7 +247,7 @@ void SHA256::transform(const unsigned char *message, unsigned int block_nb)
             wv[0] = t1 + t2;
         }
         for (j = 0; j < 8; j++) {
-            m_h[j] += wv[j];
+            h[j] += wv[j];
         }
     }
 }
@@ -72,10 +266,10 @@ void SHA256::init()
     m_tot_len = 0;
 }
  
-void SHA256::update(const unsigned char *message, unsigned int len)
+void SHA256::update(const unsigned char *message, size_t len)
 {
-    unsigned int block_nb;
-    unsigned int new_len, rem_len, tmp_len;
+    size_t block_nb;
+    size_t new_len, rem_len, tmp_len;
     const unsigned char *shifted_message;
     tmp_len = SHA224_256_BLOCK_SIZE - m_len;
     rem_len = len < tmp_len ? len : tmp_len;
@@ -91,15 +285,15 @@ void SHA256::update(const unsigned char *message, unsigned int len)
     transform(shifted_message, block_nb);
     rem_len = new_len % SHA224_256_BLOCK_SIZE;
     memcpy(m_block, &shifted_message[block_nb << 6], rem_len);
-    m_len = rem_len;
-    m_tot_len += (block_nb + 1) << 6;
+    m_len = (unsigned int) rem_len;
+    m_tot_len += (uint64) (block_nb + 1) << 6;
 }
  
 void SHA256::final(unsigned char *digest)
 {
     unsigned int block_nb;
     unsigned int pm_len;
-    unsigned int len_b;
+    uint64 len_b;
     int i;
     block_nb = (1 + ((SHA224_256_BLOCK_SIZE - 9)
                      < (m_len % SHA224_256_BLOCK_SIZE)));
@@ -107,26 +301,176 @@ void SHA256::final(unsigned char *digest)
     pm_len = block_nb << 6;
     memset(m_block + m_len, 0, pm_len - m_len);
     m_block[m_len] = 0x80;
-    SHA2_UNPACK32(len_b, m_block + pm_len - 4);
+    SHA2_UNPACK32((uint32) (len_b >> 32), m_block + pm_len - 8);
+    SHA2_UNPACK32((uint32) len_b, m_block + pm_len - 4);
     transform(m_block, block_nb);
     for (i = 0 ; i < 8; i++) {
         SHA2_UNPACK32(m_h[i], &digest[i << 2]);
     }
 }
  
-std::string sha256(std::string input)
+std::string sha256(const std::string& input)
 {
     unsigned char digest[SHA256::DIGEST_SIZE];
-    memset(digest,0,SHA256::DIGEST_SIZE);
+    sha256_digest((const uint8_t *) input.data(), input.length(), digest);
+    return sha256_hex(digest);
+}
+ 
+void sha256_digest(const uint8_t *data, size_t len, uint8_t out[SHA256::DIGEST_SIZE])
+{
+    SHA256 ctx;
+    ctx.update(data, len);
+    ctx.final(out);
+}
+ 
+/* Both hex characters of every byte value, so encoding is one lookup per byte */
+static const char sha256_hex_pairs[] =
+    "000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+    "202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+    "404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+    "606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+    "808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+    "a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+    "c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+    "e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+ 
+void sha256_hex(const unsigned char *digest, char out[2 * SHA256::DIGEST_SIZE + 1])
+{
+    for (unsigned int i = 0; i < SHA256::DIGEST_SIZE; i++) {
+        memcpy(out + 2 * i, &sha256_hex_pairs[2 * digest[i]], 2);
+    }
+    out[2 * SHA256::DIGEST_SIZE] = 0;
+}
+ 
+std::string sha256_hex(const unsigned char *digest)
+{
+    char buf[2*SHA256::DIGEST_SIZE+1];
+    sha256_hex(digest, buf);
+    return std::string(buf, 2*SHA256::DIGEST_SIZE);
+}
+ 
+static int sha256_hex_value(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+ 
+bool sha256_from_hex(const std::string& hex, unsigned char *digest)
+{
+    if (hex.length() != 2 * SHA256::DIGEST_SIZE)
+        return false;
+    for (unsigned int i = 0; i < SHA256::DIGEST_SIZE; i++) {
+        int hi = sha256_hex_value(hex[2 * i]);
+        int lo = sha256_hex_value(hex[2 * i + 1]);
+        if (hi < 0 || lo < 0)
+            return false;
+        digest[i] = (unsigned char) ((hi << 4) | lo);
+    }
+    return true;
+}
+ 
+/* Bytes hashed per read() when the input cannot be mapped */
+static const size_t SHA256_READ_CHUNK = 1 << 20;
  
-    SHA256 ctx = SHA256();
+#if SHA256_HAVE_POSIX
+/* Mapped bytes hashed before the pages behind them are dropped again */
+static const size_t SHA256_MAP_WINDOW = 64 << 20;
+ 
+/* Hashes the mapped file from offset start to its end, releasing pages once
+ * they have been hashed so multi-gigabyte inputs do not stay resident. */
+static bool sha256_mapped(int fd, size_t size, size_t start, SHA256 &ctx)
+{
+    void *map = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED)
+        return false;
+    const unsigned char *data = (const unsigned char *) map;
+    madvise(map, size, MADV_SEQUENTIAL);
+    for (size_t pos = start; pos < size; ) {
+        size_t n = size - pos < SHA256_MAP_WINDOW ? size - pos : SHA256_MAP_WINDOW;
+        ctx.update(data + pos, n);
+        pos += n;
+        size_t done = pos & ~(SHA256_MAP_WINDOW - 1);
+        if (done > 0)
+            madvise(map, done, MADV_DONTNEED);
+    }
+    munmap(map, size);
+    return true;
+}
+ 
+bool sha256_fd(int fd, unsigned char *digest)
+{
+    SHA256 ctx;
     ctx.init();
-    ctx.update( (unsigned char*)input.c_str(), input.length());
+ 
+    struct stat st;
+    off_t start = lseek(fd, 0, SEEK_CUR);
+    if (start >= 0 && fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > start) {
+        if (sha256_mapped(fd, (size_t) st.st_size, (size_t) start, ctx)) {
+            lseek(fd, 0, SEEK_END);
+            ctx.final(digest);
+            return true;
+        }
+    }
+ 
+    /* Pipes, sockets and files that cannot be mapped */
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    void *buf;
+    if (posix_memalign(&buf, 4096, SHA256_READ_CHUNK) != 0)
+        return false;
+    for (;;) {
+        ssize_t n = read(fd, buf, SHA256_READ_CHUNK);
+        if (n == 0)
+            break;
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            free(buf);
+            return false;
+        }
+        ctx.update((const unsigned char *) buf, (size_t) n);
+    }
+    free(buf);
     ctx.final(digest);
+    return true;
+}
  
-    char buf[2*SHA256::DIGEST_SIZE+1];
-    buf[2*SHA256::DIGEST_SIZE] = 0;
-    for (int i = 0; i < SHA256::DIGEST_SIZE; i++)
-        sprintf(buf+i*2, "%02x", digest[i]);
-    return std::string(buf);
-}
\ No newline at end of file
+bool sha256_file(const std::string& path, unsigned char *digest)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    bool ok = sha256_fd(fd, digest);
+    close(fd);
+    return ok;
+}
+#else
+bool sha256_fd(int fd, unsigned char *digest)
+{
+    return false;
+}
+ 
+bool sha256_file(const std::string& path, unsigned char *digest)
+{
+    std::ifstream in(path.c_str(), std::ios::binary);
+    if (!in)
+        return false;
+    std::string buf(SHA256_READ_CHUNK, 0);
+    SHA256 ctx;
+    ctx.init();
+    while (in) {
+        in.read(&buf[0], buf.size());
+        ctx.update((const unsigned char *) buf.data(), (size_t) in.gcount());
+    }
+    if (in.bad())
+        return false;
+    ctx.final(digest);
+    return true;
+}
+#endif
\ No newline at end of file
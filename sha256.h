@@ -1,6 +1,15 @@
 #ifndef SHA256_H
 #define SHA256_H
 #include <string>
+#include <cstddef>
+#include <stdint.h>
+ 
+/* x86 SIMD block transforms (sha256_x86.cc) need GCC-style target attributes */
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define SHA256_HAVE_X86 1
+#else
+#define SHA256_HAVE_X86 0
+#endif
  
 class SHA256
 {
@@ -12,20 +21,110 @@ protected:
     const static uint32 sha256_k[];
     static const unsigned int SHA224_256_BLOCK_SIZE = (512/8);
 public:
+    SHA256() { init(); }
     void init();
-    void update(const unsigned char *message, unsigned int len);
+    void update(const unsigned char *message, size_t len);
     void final(unsigned char *digest);
     static const unsigned int DIGEST_SIZE = ( 256 / 8);
  
+    /* Block transform implementations. The fastest one supported by the
+     * running CPU is selected once at startup via CPUID; set_backend() lets
+     * benchmarks and tests force a specific one. */
+    enum Backend { BACKEND_GENERIC, BACKEND_AVX2, BACKEND_SHANI };
+    static Backend backend();
+    static bool backend_supported(Backend b);
+    static bool set_backend(Backend b);
+    static const char *backend_name(Backend b);
+ 
+    /* Number of messages sha256_batch() hashes side by side: 16 (AVX-512),
+     * 8 (AVX2), 4 (SSE2) or 1 (one after another with the block transform
+     * above). Defaults to the fastest option on the running CPU. */
+    static unsigned int batch_lanes();
+    static bool batch_lanes_supported(unsigned int lanes);
+    static bool set_batch_lanes(unsigned int lanes);
+ 
 protected:
-    void transform(const unsigned char *message, unsigned int block_nb);
-    unsigned int m_tot_len;
+    typedef void (*transform_fn)(uint32 *h, const unsigned char *message,
+                                 size_t block_nb);
+    static Backend s_backend;
+    static transform_fn s_transform;
+    static Backend detect_backend();
+    static transform_fn backend_transform(Backend b);
+    static void transform_generic(uint32 *h, const unsigned char *message,
+                                  size_t block_nb);
+    static void transform_avx2(uint32 *h, const unsigned char *message,
+                               size_t block_nb);
+    static void transform_shani(uint32 *h, const unsigned char *message,
+                                size_t block_nb);
+ 
+    /* Multi-buffer kernels (sha256_mb.cc): one block for each lane, with
+     * state and words stored lane-interleaved; lanes with active == 0 keep
+     * their state. */
+    typedef void (*transform_mb_fn)(uint32 *state, const uint32 *words,
+                                    const uint32 *active);
+    static unsigned int s_batch_lanes;
+    static unsigned int detect_batch_lanes();
+    static transform_mb_fn batch_transform(unsigned int lanes);
+    static void transform_mb4(uint32 *state, const uint32 *words, const uint32 *active);
+    static void transform_mb8(uint32 *state, const uint32 *words, const uint32 *active);
+    static void transform_mb16(uint32 *state, const uint32 *words, const uint32 *active);
+    friend class Microbench;
+    friend void sha256_batch(const unsigned char *const *messages, const size_t *lengths,
+                             unsigned char *digests, size_t count);
+ 
+    void transform(const unsigned char *message, size_t block_nb)
+    {
+        s_transform(m_h, message, block_nb);
+    }
+    uint64 m_tot_len;
     unsigned int m_len;
     unsigned char m_block[2*SHA224_256_BLOCK_SIZE];
     uint32 m_h[8];
 };
  
-std::string sha256(std::string input);
+std::string sha256(const std::string& input);
+ 
+/* One-shot binary digest of len bytes at data into out. Uses a context on
+ * the stack and performs no allocation. */
+void sha256_digest(const uint8_t *data, size_t len, uint8_t out[SHA256::DIGEST_SIZE]);
+ 
+/* Hash a whole file (or an already open descriptor, read to EOF) without
+ * holding it in memory: regular files are mapped, anything else is read in
+ * large aligned chunks. Return false if the input could not be read. */
+bool sha256_file(const std::string& path, unsigned char *digest);
+bool sha256_fd(int fd, unsigned char *digest);
+ 
+/* Hashes count independent messages (messages[i], lengths[i] bytes), several
+ * at a time across SIMD lanes. Digest i is written to
+ * digests + i * SHA256::DIGEST_SIZE. */
+void sha256_batch(const unsigned char *const *messages, const size_t *lengths,
+                  unsigned char *digests, size_t count);
+ 
+/* Lowercase hex encoding of a binary digest, as returned by sha256(). The
+ * buffer form writes 2 * DIGEST_SIZE characters plus a terminating NUL. */
+std::string sha256_hex(const unsigned char *digest);
+void sha256_hex(const unsigned char *digest, char out[2 * SHA256::DIGEST_SIZE + 1]);
+ 
+/* Parses 2 * DIGEST_SIZE hex characters (either case) back into a digest.
+ * Returns false if hex has the wrong length or a non-hex character. */
+bool sha256_from_hex(const std::string& hex, unsigned char *digest);
+ 
+/* Tree prehash for very large messages (sha256_tree.cc). The input is cut
+ * into leaf_size-byte leaves whose digests are computed on a pool of worker
+ * threads (threads == 0: one per hardware thread), each worker hashing its
+ * leaves with sha256_batch(). The root is SHA-256 over a tag byte, the leaf
+ * size and total length (64-bit big-endian) and the leaf digests in order.
+ * The result depends on leaf_size but not on the thread count, and differs
+ * from sha256_digest() of the same data. */
+static const size_t SHA256_TREE_LEAF_SIZE = 1 << 20;
+void sha256_tree(const uint8_t *data, size_t len, uint8_t out[SHA256::DIGEST_SIZE],
+                 size_t leaf_size = SHA256_TREE_LEAF_SIZE, unsigned int threads = 0);
+ 
+/* How a signer reduces a message to the representative it signs: one
+ * sequential SHA-256 pass, or the tree-parallel digest above */
+enum Sha256Prehash { SHA256_PREHASH_SEQUENTIAL, SHA256_PREHASH_TREE };
+void sha256_prehash(const uint8_t *data, size_t len, uint8_t out[SHA256::DIGEST_SIZE],
+                    Sha256Prehash mode);
  
 #define SHA2_SHFR(x, n)    (x >> n)
 #define SHA2_ROTR(x, n)   ((x >> n) | (x << ((sizeof(x) << 3) - n)))
@@ -0,0 +1,208 @@
+#include <cstring>
+#include <stdint.h>
+#include <algorithm>
+#include <vector>
+#include "sha256.h"
+
+#if SHA256_HAVE_X86
+/* GCC 12 flags the deliberately undefined pass-through operand of the
+ * unmasked AVX-512 intrinsics as uninitialized (GCC bug 105593). */
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#include <immintrin.h>
+#pragma GCC diagnostic pop
+
+typedef unsigned int uint32;
+
+/* 4 lanes: SSE2 */
+#define MB_LANES 4
+#define MB_FN transform_mb4
+#define MB_TARGET __attribute__((target("sse2")))
+#define MB_V __m128i
+#define MB_LOAD(p) _mm_load_si128((const __m128i *) (p))
+#define MB_STORE(p, x) _mm_store_si128((__m128i *) (p), x)
+#define MB_SET1(x) _mm_set1_epi32((int) (x))
+#define MB_ADD _mm_add_epi32
+#define MB_XOR _mm_xor_si128
+#define MB_AND _mm_and_si128
+#define MB_OR _mm_or_si128
+#define MB_ANDNOT _mm_andnot_si128
+#define MB_SHR _mm_srli_epi32
+#define MB_ROTR(x, n) _mm_or_si128(_mm_srli_epi32(x, n), _mm_slli_epi32(x, 32 - (n)))
+#include "sha256_mb.inc"
+#undef MB_LANES
+#undef MB_FN
+#undef MB_TARGET
+#undef MB_V
+#undef MB_LOAD
+#undef MB_STORE
+#undef MB_SET1
+#undef MB_ADD
+#undef MB_XOR
+#undef MB_AND
+#undef MB_OR
+#undef MB_ANDNOT
+#undef MB_SHR
+#undef MB_ROTR
+
+/* 8 lanes: AVX2 */
+#define MB_LANES 8
+#define MB_FN transform_mb8
+#define MB_TARGET __attribute__((target("avx2")))
+#define MB_V __m256i
+#define MB_LOAD(p) _mm256_load_si256((const __m256i *) (p))
+#define MB_STORE(p, x) _mm256_store_si256((__m256i *) (p), x)
+#define MB_SET1(x) _mm256_set1_epi32((int) (x))
+#define MB_ADD _mm256_add_epi32
+#define MB_XOR _mm256_xor_si256
+#define MB_AND _mm256_and_si256
+#define MB_OR _mm256_or_si256
+#define MB_ANDNOT _mm256_andnot_si256
+#define MB_SHR _mm256_srli_epi32
+#define MB_ROTR(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#include "sha256_mb.inc"
+#undef MB_LANES
+#undef MB_FN
+#undef MB_TARGET
+#undef MB_V
+#undef MB_LOAD
+#undef MB_STORE
+#undef MB_SET1
+#undef MB_ADD
+#undef MB_XOR
+#undef MB_AND
+#undef MB_OR
+#undef MB_ANDNOT
+#undef MB_SHR
+#undef MB_ROTR
+
+/* 16 lanes: AVX-512F, which also has a native rotate */
+#define MB_LANES 16
+#define MB_FN transform_mb16
+#define MB_TARGET __attribute__((target("avx512f")))
+#define MB_V __m512i
+#define MB_LOAD(p) _mm512_load_si512((const void *) (p))
+#define MB_STORE(p, x) _mm512_store_si512((void *) (p), x)
+#define MB_SET1(x) _mm512_set1_epi32((int) (x))
+#define MB_ADD _mm512_add_epi32
+#define MB_XOR _mm512_xor_si512
+#define MB_AND _mm512_and_si512
+#define MB_OR _mm512_or_si512
+#define MB_ANDNOT _mm512_andnot_si512
+#define MB_SHR _mm512_srli_epi32
+#define MB_ROTR _mm512_ror_epi32
+#include "sha256_mb.inc"
+#undef MB_LANES
+#undef MB_FN
+#undef MB_TARGET
+#undef MB_V
+#undef MB_LOAD
+#undef MB_STORE
+#undef MB_SET1
+#undef MB_ADD
+#undef MB_XOR
+#undef MB_AND
+#undef MB_OR
+#undef MB_ANDNOT
+#undef MB_SHR
+#undef MB_ROTR
+
+#endif /* SHA256_HAVE_X86 */
+
+/* Number of padded 64-byte blocks for a message of len bytes */
+static size_t padded_blocks(size_t len)
+{
+    return (len + 9 + 63) / 64;
+}
+
+void sha256_batch(const unsigned char *const *messages, const size_t *lengths,
+                  unsigned char *digests, size_t count)
+{
+    typedef unsigned char uint8;
+    typedef SHA256::uint32 uint32;
+    const unsigned int max_lanes = 16;
+    unsigned int lanes = SHA256::s_batch_lanes;
+    SHA256::transform_mb_fn block = SHA256::batch_transform(lanes);
+    SHA256 iv;
+    iv.init();
+
+    if (!block) {
+        for (size_t i = 0; i < count; i++) {
+            SHA256 ctx = iv;
+            ctx.update(messages[i], lengths[i]);
+            ctx.final(digests + i * SHA256::DIGEST_SIZE);
+        }
+        return;
+    }
+
+    /* Group messages of similar padded length so lanes finish together. */
+    std::vector<size_t> order(count);
+    for (size_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [lengths](size_t x, size_t y) {
+        return padded_blocks(lengths[x]) < padded_blocks(lengths[y]);
+    });
+
+    alignas(64) uint32 state[8 * max_lanes];
+    alignas(64) uint32 words[16 * max_lanes];
+    alignas(64) uint32 active[max_lanes];
+    static const unsigned char zero_block[64] = {0};
+    unsigned char tail[max_lanes][2 * 64];
+    size_t full[max_lanes];
+    size_t nb[max_lanes];
+
+    for (size_t start = 0; start < count; start += lanes) {
+        size_t used = std::min<size_t>(lanes, count - start);
+        size_t max_nb = 0;
+        for (unsigned int l = 0; l < lanes; l++) {
+            for (int i = 0; i < 8; i++) {
+                state[i * lanes + l] = iv.m_h[i];
+            }
+            if (l >= used) {
+                full[l] = nb[l] = 0;
+                continue;
+            }
+            size_t idx = order[start + l];
+            size_t len = lengths[idx];
+            size_t rem = len % 64;
+            full[l] = len / 64;
+            nb[l] = padded_blocks(len);
+            size_t tail_len = (nb[l] - full[l]) * 64;
+            memset(tail[l], 0, tail_len);
+            memcpy(tail[l], messages[idx] + full[l] * 64, rem);
+            tail[l][rem] = 0x80;
+            uint64_t bits = (uint64_t) len << 3;
+            for (int i = 0; i < 8; i++) {
+                tail[l][tail_len - 1 - i] = (uint8) (bits >> (8 * i));
+            }
+            max_nb = std::max(max_nb, nb[l]);
+        }
+
+        for (size_t t = 0; t < max_nb; t++) {
+            for (unsigned int l = 0; l < lanes; l++) {
+                const unsigned char *src;
+                if (t < full[l]) {
+                    src = messages[order[start + l]] + t * 64;
+                } else if (t < nb[l]) {
+                    src = tail[l] + (t - full[l]) * 64;
+                } else {
+                    src = zero_block;
+                }
+                active[l] = t < nb[l] ? 0xffffffff : 0;
+                for (int j = 0; j < 16; j++) {
+                    SHA2_PACK32(&src[j << 2], &words[j * lanes + l]);
+                }
+            }
+            block(state, words, active);
+        }
+
+        for (size_t l = 0; l < used; l++) {
+            unsigned char *digest = digests + order[start + l] * SHA256::DIGEST_SIZE;
+            for (int i = 0; i < 8; i++) {
+                SHA2_UNPACK32(state[i * lanes + l], &digest[i << 2]);
+            }
+        }
+    }
+}
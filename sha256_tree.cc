@@ -0,0 +1,76 @@
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "sha256.h"
+
+/* Leading byte of the root input; leaves are hashed untagged so that
+ * sha256_batch() can read them in place. */
+static const unsigned char SHA256_TREE_ROOT_TAG = 0x01;
+
+/* Hashes leaves [first, last) of data into digests, SIMD lanes at a time */
+static void sha256_tree_leaves(const uint8_t *data, size_t len, size_t leaf_size,
+                               size_t first, size_t last, unsigned char *digests)
+{
+    std::vector<const unsigned char *> ptrs(last - first);
+    std::vector<size_t> lengths(last - first);
+    for (size_t i = first; i < last; i++) {
+        ptrs[i - first] = data + i * leaf_size;
+        lengths[i - first] = std::min(leaf_size, len - i * leaf_size);
+    }
+    sha256_batch(ptrs.data(), lengths.data(), digests + first * SHA256::DIGEST_SIZE,
+                 last - first);
+}
+
+void sha256_tree(const uint8_t *data, size_t len, uint8_t out[SHA256::DIGEST_SIZE],
+                 size_t leaf_size, unsigned int threads)
+{
+    if (leaf_size == 0)
+        leaf_size = SHA256_TREE_LEAF_SIZE;
+    size_t leaves = (len + leaf_size - 1) / leaf_size;
+    std::vector<unsigned char> digests(leaves * SHA256::DIGEST_SIZE);
+
+    /* Workers claim groups of leaves that fill the SIMD lanes */
+    size_t group = SHA256::batch_lanes();
+    size_t groups = (leaves + group - 1) / group;
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    unsigned int workers = (unsigned int) std::min<size_t>(threads, groups);
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+        size_t g;
+        while ((g = next.fetch_add(1)) < groups) {
+            sha256_tree_leaves(data, len, leaf_size, g * group,
+                               std::min(leaves, (g + 1) * group), digests.data());
+        }
+    };
+    std::vector<std::thread> pool;
+    for (unsigned int t = 1; t < workers; t++) {
+        pool.push_back(std::thread(work));
+    }
+    work();
+    for (size_t t = 0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+
+    unsigned char header[17];
+    header[0] = SHA256_TREE_ROOT_TAG;
+    for (int i = 0; i < 8; i++) {
+        header[8 - i] = (unsigned char) ((uint64_t) leaf_size >> (8 * i));
+        header[16 - i] = (unsigned char) ((uint64_t) len >> (8 * i));
+    }
+    SHA256 ctx;
+    ctx.update(header, sizeof(header));
+    ctx.update(digests.data(), digests.size());
+    ctx.final(out);
+}
+
+void sha256_prehash(const uint8_t *data, size_t len, uint8_t out[SHA256::DIGEST_SIZE],
+                    Sha256Prehash mode)
+{
+    if (mode == SHA256_PREHASH_TREE) {
+        sha256_tree(data, len, out);
+    } else {
+        sha256_digest(data, len, out);
+    }
+}
@@ -0,0 +1,46 @@
+#include "sha256_uecc.h"
+
+static SHA256HashContext *hash_context(const uECC_HashContext *base)
+{
+    return const_cast<SHA256HashContext *>(reinterpret_cast<const SHA256HashContext *>(base));
+}
+
+static void init_hash(const uECC_HashContext *base)
+{
+    hash_context(base)->sha.init();
+}
+
+static void update_hash(const uECC_HashContext *base, const uint8_t *message,
+                        unsigned message_size)
+{
+    hash_context(base)->sha.update(message, message_size);
+}
+
+static void finish_hash(const uECC_HashContext *base, uint8_t *hash_result)
+{
+    hash_context(base)->sha.final(hash_result);
+}
+
+static void save_state(const uECC_HashContext *base, unsigned slot)
+{
+    SHA256HashContext *context = hash_context(base);
+    context->saved[slot] = context->sha;
+}
+
+static void restore_state(const uECC_HashContext *base, unsigned slot)
+{
+    SHA256HashContext *context = hash_context(base);
+    context->sha = context->saved[slot];
+}
+
+SHA256HashContext::SHA256HashContext(bool cacheKeyStates)
+{
+    uECC.init_hash = &init_hash;
+    uECC.update_hash = &update_hash;
+    uECC.finish_hash = &finish_hash;
+    uECC.block_size = sizeof(tmp) - 2 * SHA256::DIGEST_SIZE;
+    uECC.result_size = SHA256::DIGEST_SIZE;
+    uECC.tmp = tmp;
+    uECC.save_state = cacheKeyStates ? &save_state : 0;
+    uECC.restore_state = cacheKeyStates ? &restore_state : 0;
+}
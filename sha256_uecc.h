@@ -0,0 +1,27 @@
+#ifndef SHA256_UECC_H
+#define SHA256_UECC_H
+#include "sha256.h"
+#include "ecc/uECC.h"
+
+/* uECC_HashContext for uECC_sign_deterministic() backed by SHA256. Pass
+ * &ctx.uECC; it has to stay the first member, as uECC hands that address back
+ * to the callbacks. With cacheKeyStates, the states after the HMAC key pads of
+ * the current K are kept in saved (see uECC_HashContext), so every further HMAC
+ * under that K hashes only its message and the inner digest: two SHA-256
+ * blocks instead of four. Without it, uECC rehashes both pads each time. */
+struct SHA256HashContext
+{
+    uECC_HashContext uECC;
+    SHA256 sha;
+    SHA256 saved[2];
+    uint8_t tmp[2 * SHA256::DIGEST_SIZE + 64];
+
+    explicit SHA256HashContext(bool cacheKeyStates = true);
+
+private:
+    /* uECC.tmp points into the object */
+    SHA256HashContext(const SHA256HashContext&);
+    SHA256HashContext& operator=(const SHA256HashContext&);
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include "sha256.h"
+
+#if SHA256_HAVE_X86
+#include <immintrin.h>
+
+typedef unsigned int uint32;
+
+/* One round with the message word already added to its round constant.
+ * The caller rotates the roles of a..h instead of shuffling registers. */
+#define SHA256_RND(a, b, c, d, e, f, g, h, wk)                       \
+{                                                                     \
+    uint32 t1 = (h) + SHA256_F2(e) + SHA2_CH(e, f, g) + (wk);         \
+    uint32 t2 = SHA256_F1(a) + SHA2_MAJ(a, b, c);                     \
+    (d) += t1;                                                        \
+    (h) = t1 + t2;                                                    \
+}
+
+#define SHA256_ROTR_V(x, n) \
+    _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define SHA256_F3_V(x) _mm256_xor_si256(_mm256_xor_si256( \
+    SHA256_ROTR_V(x, 7), SHA256_ROTR_V(x, 18)), _mm256_srli_epi32(x, 3))
+#define SHA256_F4_V(x) _mm256_xor_si256(_mm256_xor_si256( \
+    SHA256_ROTR_V(x, 17), SHA256_ROTR_V(x, 19)), _mm256_srli_epi32(x, 10))
+
+/* Computes w[j..j+3] from x0 = w[j-16..j-13] ... x3 = w[j-4..j-1], independently
+ * in each 128-bit lane. w[j+2] and w[j+3] depend on w[j] and w[j+1], so the
+ * SHA256_F4 term is applied in two halves. */
+__attribute__((target("avx2")))
+static inline __m256i sha256_schedule4(__m256i x0, __m256i x1, __m256i x2, __m256i x3)
+{
+    const __m256i lo = _mm256_setr_epi32(-1, -1, 0, 0, -1, -1, 0, 0);
+    __m256i w15 = _mm256_alignr_epi8(x1, x0, 4);
+    __m256i w7 = _mm256_alignr_epi8(x3, x2, 4);
+    __m256i t = _mm256_add_epi32(_mm256_add_epi32(x0, w7), SHA256_F3_V(w15));
+    __m256i s = SHA256_F4_V(_mm256_shuffle_epi32(x3, 0xee));
+    t = _mm256_add_epi32(t, _mm256_and_si256(s, lo));
+    s = SHA256_F4_V(_mm256_shuffle_epi32(t, 0x44));
+    return _mm256_add_epi32(t, _mm256_andnot_si256(lo, s));
+}
+
+static inline void sha256_rounds(uint32 *h, const uint32 *wk)
+{
+    uint32 a = h[0], b = h[1], c = h[2], d = h[3];
+    uint32 e = h[4], f = h[5], g = h[6], hh = h[7];
+    for (int j = 0; j < 64; j += 8) {
+        SHA256_RND(a, b, c, d, e, f, g, hh, wk[j + 0]);
+        SHA256_RND(hh, a, b, c, d, e, f, g, wk[j + 1]);
+        SHA256_RND(g, hh, a, b, c, d, e, f, wk[j + 2]);
+        SHA256_RND(f, g, hh, a, b, c, d, e, wk[j + 3]);
+        SHA256_RND(e, f, g, hh, a, b, c, d, wk[j + 4]);
+        SHA256_RND(d, e, f, g, hh, a, b, c, wk[j + 5]);
+        SHA256_RND(c, d, e, f, g, hh, a, b, wk[j + 6]);
+        SHA256_RND(b, c, d, e, f, g, hh, a, wk[j + 7]);
+    }
+    h[0] += a; h[1] += b; h[2] += c; h[3] += d;
+    h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
+}
+
+/* Message schedule for two consecutive blocks at once (one per 128-bit lane),
+ * followed by scalar rounds; BMI2 lets the compiler use rorx for the rotates. */
+__attribute__((target("avx2,bmi2")))
+void SHA256::transform_avx2(uint32 *h, const unsigned char *message, size_t block_nb)
+{
+    const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                           3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    alignas(32) uint32 wk[2][64];
+    for (size_t i = 0; i < block_nb; i += 2) {
+        const unsigned char *b0 = message + (i << 6);
+        const unsigned char *b1 = (i + 1 < block_nb) ? b0 + 64 : b0;
+        __m256i x[4];
+        for (int j = 0; j < 4; j++) {
+            __m128i lo = _mm_loadu_si128((const __m128i *) (b0 + 16 * j));
+            __m128i hi = _mm_loadu_si128((const __m128i *) (b1 + 16 * j));
+            x[j] = _mm256_shuffle_epi8(
+                _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1), bswap);
+        }
+        for (int j = 0; j < 16; j++) {
+            if (j >= 4) {
+                x[j & 3] = sha256_schedule4(x[j & 3], x[(j + 1) & 3],
+                                            x[(j + 2) & 3], x[(j + 3) & 3]);
+            }
+            __m256i k = _mm256_broadcastsi128_si256(
+                _mm_loadu_si128((const __m128i *) &sha256_k[4 * j]));
+            __m256i t = _mm256_add_epi32(x[j & 3], k);
+            _mm_store_si128((__m128i *) &wk[0][4 * j], _mm256_castsi256_si128(t));
+            _mm_store_si128((__m128i *) &wk[1][4 * j], _mm256_extracti128_si256(t, 1));
+        }
+        sha256_rounds(h, wk[0]);
+        if (i + 1 < block_nb)
+            sha256_rounds(h, wk[1]);
+    }
+}
+
+/* Intel SHA extensions. The state is kept as ABEF/CDGH as sha256rnds2 expects;
+ * each group of four rounds also advances the message schedule with
+ * sha256msg1/sha256msg2 for the group three steps ahead. */
+__attribute__((target("sha,sse4.1,ssse3")))
+void SHA256::transform_shani(uint32 *h, const unsigned char *message, size_t block_nb)
+{
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+    __m128i tmp = _mm_loadu_si128((const __m128i *) &h[0]);
+    __m128i state1 = _mm_loadu_si128((const __m128i *) &h[4]);
+    tmp = _mm_shuffle_epi32(tmp, 0xb1);
+    state1 = _mm_shuffle_epi32(state1, 0x1b);
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);
+    state1 = _mm_blend_epi16(state1, tmp, 0xf0);
+
+    for (size_t i = 0; i < block_nb; i++) {
+        const unsigned char *block = message + (i << 6);
+        __m128i abef = state0;
+        __m128i cdgh = state1;
+        __m128i w[4];
+        for (int g = 0; g < 16; g++) {
+            if (g < 4) {
+                w[g] = _mm_shuffle_epi8(
+                    _mm_loadu_si128((const __m128i *) (block + 16 * g)), bswap);
+            }
+            __m128i msg = _mm_add_epi32(w[g & 3],
+                _mm_loadu_si128((const __m128i *) &sha256_k[4 * g]));
+            state1 = _mm_sha256rnds2_epu32(state1, state0, msg);
+            if (g >= 3 && g <= 14) {
+                __m128i t = _mm_alignr_epi8(w[g & 3], w[(g + 3) & 3], 4);
+                w[(g + 1) & 3] = _mm_add_epi32(w[(g + 1) & 3], t);
+                w[(g + 1) & 3] = _mm_sha256msg2_epu32(w[(g + 1) & 3], w[g & 3]);
+            }
+            msg = _mm_shuffle_epi32(msg, 0x0e);
+            state0 = _mm_sha256rnds2_epu32(state0, state1, msg);
+            if (g >= 1 && g <= 12)
+                w[(g + 3) & 3] = _mm_sha256msg1_epu32(w[(g + 3) & 3], w[g & 3]);
+        }
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+    }
+
+    tmp = _mm_shuffle_epi32(state0, 0x1b);
+    state1 = _mm_shuffle_epi32(state1, 0xb1);
+    state0 = _mm_blend_epi16(tmp, state1, 0xf0);
+    state1 = _mm_alignr_epi8(state1, tmp, 8);
+    _mm_storeu_si128((__m128i *) &h[0], state0);
+    _mm_storeu_si128((__m128i *) &h[4], state1);
+}
+
+#endif /* SHA256_HAVE_X86 */